@@ -3,22 +3,55 @@
 #include "SUNImage.h"
 
 #include "SlateOptMacros.h"
+#include "UNStats.h"
+
+SLATE_IMPLEMENT_WIDGET(SUNImage)
+
+void SUNImage::PrivateRegisterAttributes(FSlateAttributeInitializer& AttributeInitializer)
+{
+  // Any change to a folded color input must rebuild the folded tint.
+  const FSlateAttributeDescriptor::FAttributeValueChangedDelegate OnFoldedInputChanged = FSlateAttributeDescriptor::FAttributeValueChangedDelegate::CreateLambda([](SWidget& Widget)
+  {
+    static_cast<SUNImage&>(Widget).InvalidateFoldedTint();
+  });
+
+  SLATE_ADD_MEMBER_ATTRIBUTE_DEFINITION(AttributeInitializer, CollectionColor, EInvalidateWidgetReason::Paint)
+    .OnValueChanged(FSlateAttributeDescriptor::FAttributeValueChangedDelegate::CreateLambda([](SWidget& Widget)
+    {
+      INC_DWORD_STAT(STAT_UNiq_PaintInvalidations);
+      static_cast<SUNImage&>(Widget).InvalidateFoldedTint();
+    }));
+  SLATE_ADD_MEMBER_ATTRIBUTE_DEFINITION(AttributeInitializer, FlipForRightToLeftFlowDirection, EInvalidateWidgetReason::Paint);
+
+  AttributeInitializer.OverrideOnValueChanged("ColorAndOpacity", FSlateAttributeDescriptor::ECallbackOverrideType::ExecuteAfterPrevious, OnFoldedInputChanged);
+}
+
+SUNImage::SUNImage()
+  : CollectionColor(*this, FLinearColor::White)
+  , FlipForRightToLeftFlowDirection(*this, false)
+  , FoldedTint(FLinearColor::White)
+  , FoldedBrush(nullptr)
+  , bFoldedTintDirty(true)
+  , bFoldedTintIsStyleFree(false)
+  , ResolvedCollectionColor(FLinearColor::White)
+  , bCollectionColorDirty(false)
+{
+  SetCanTick(false);
+  bCanSupportFocus = false;
+}
 
 BEGIN_SLATE_FUNCTION_BUILD_OPTIMIZATION
 
 void SUNImage::Construct(const FArguments& InArgs)
 {
-  /*
-	ChildSlot
-	[
-		// Populate the widget
-	];
-	*/
+  CollectionColor.Assign(*this, InArgs._CollectionColor);
 }
 
 int32 SUNImage::OnPaint(const FPaintArgs& Args, const FGeometry& AllottedGeometry, const FSlateRect& MyCullingRect,
   FSlateWindowElementList& OutDrawElements, int32 LayerId, const FWidgetStyle& InWidgetStyle, bool bParentEnabled) const
 {
+  UN_SCOPE_CYCLE_COUNTER(STAT_UNiq_ImagePaint);
+
   const FSlateBrush* ImageBrush = Image.GetImage().Get();
 
   if ((ImageBrush != nullptr) && (ImageBrush->DrawAs != ESlateBrushDrawType::NoDrawType))
@@ -26,9 +59,9 @@ int32 SUNImage::OnPaint(const FPaintArgs& Args, const FGeometry& AllottedGeometr
     const bool bIsEnabled = ShouldBeEnabled(bParentEnabled);
     const ESlateDrawEffect DrawEffects = bIsEnabled ? ESlateDrawEffect::None : ESlateDrawEffect::DisabledEffect;
 
-    const FLinearColor FinalColorAndOpacity( InWidgetStyle.GetColorAndOpacityTint() * CollectionColor.Get().GetColor(InWidgetStyle) * ColorAndOpacity.Get().GetColor(InWidgetStyle) * ImageBrush->GetTint( InWidgetStyle ) );
+    const FLinearColor FinalColorAndOpacity = GetFinalColorAndOpacity(ImageBrush, InWidgetStyle);
 
-    if (bFlipForRightToLeftFlowDirection && GSlateFlowDirection == EFlowDirection::RightToLeft)
+    if (FlipForRightToLeftFlowDirection.Get() && GSlateFlowDirection == EFlowDirection::RightToLeft)
     {
       const FGeometry FlippedGeometry = AllottedGeometry.MakeChild(FSlateRenderTransform(FScale2D(-1, 1)));
       FSlateDrawElement::MakeBox(OutDrawElements, LayerId, FlippedGeometry.ToPaintGeometry(), ImageBrush, DrawEffects, FinalColorAndOpacity);
@@ -42,19 +75,93 @@ int32 SUNImage::OnPaint(const FPaintArgs& Args, const FGeometry& AllottedGeometr
   return LayerId;
 }
 
+FLinearColor SUNImage::GetFinalColorAndOpacity(const FSlateBrush* ImageBrush, const FWidgetStyle& InWidgetStyle) const
+{
+  if (bCollectionColorDirty)
+  {
+    bCollectionColorDirty = false;
+
+    const FLinearColor NewColor = CollectionColorResolver.IsBound() ? CollectionColorResolver.Execute() : ResolvedCollectionColor;
+    if (NewColor != ResolvedCollectionColor)
+    {
+      ResolvedCollectionColor = NewColor;
+      bFoldedTintDirty = true;
+    }
+  }
+
+  // The brush tint lives in the brush itself, so it has to be checked here instead of through a callback.
+  if (bFoldedTintDirty || FoldedBrush != ImageBrush || FoldedBrushTint != ImageBrush->TintColor)
+    UpdateFoldedTint(ImageBrush);
+
+  if (bFoldedTintIsStyleFree)
+    return InWidgetStyle.GetColorAndOpacityTint() * FoldedTint;
+
+  return InWidgetStyle.GetColorAndOpacityTint() * GetEffectiveCollectionColor().GetColor(InWidgetStyle) * ColorAndOpacity.Get().GetColor(InWidgetStyle) * ImageBrush->GetTint(InWidgetStyle);
+}
+
+void SUNImage::UpdateFoldedTint(const FSlateBrush* ImageBrush) const
+{
+  const FSlateColor CollectionSlateColor = GetEffectiveCollectionColor();
+  const FSlateColor& ColorAndOpacitySlateColor = ColorAndOpacity.Get();
+
+  FoldedBrush = ImageBrush;
+  FoldedBrushTint = ImageBrush->TintColor;
+  bFoldedTintDirty = false;
+
+  // Colors that use the foreground depend on the widget style, and can't be folded ahead of time.
+  bFoldedTintIsStyleFree = CollectionSlateColor.IsColorSpecified() && ColorAndOpacitySlateColor.IsColorSpecified() && FoldedBrushTint.IsColorSpecified();
+
+  if (bFoldedTintIsStyleFree)
+    FoldedTint = CollectionSlateColor.GetSpecifiedColor() * ColorAndOpacitySlateColor.GetSpecifiedColor() * FoldedBrushTint.GetSpecifiedColor();
+}
+
+void SUNImage::InvalidateFoldedTint()
+{
+  bFoldedTintDirty = true;
+}
+
+FSlateColor SUNImage::GetEffectiveCollectionColor() const
+{
+  return CollectionColorResolver.IsBound() ? FSlateColor(ResolvedCollectionColor) : CollectionColor.Get();
+}
+
+void SUNImage::SetCollectionColorResolver(const FOnResolveCollectionColor& InResolver)
+{
+  CollectionColorResolver = InResolver;
+  bCollectionColorDirty = CollectionColorResolver.IsBound();
+
+  InvalidateFoldedTint();
+  INC_DWORD_STAT(STAT_UNiq_PaintInvalidations);
+  Invalidate(EInvalidateWidgetReason::Paint);
+}
+
+void SUNImage::MarkCollectionColorDirty()
+{
+  // Only the first mark invalidates. Hidden widgets are never painted, so further marks cost nothing.
+  if (bCollectionColorDirty)
+    return;
+
+  bCollectionColorDirty = true;
+  INC_DWORD_STAT(STAT_UNiq_PaintInvalidations);
+  Invalidate(EInvalidateWidgetReason::Paint);
+}
+
 void SUNImage::SetCollectionColor(FLinearColor InColor)
 {
-  SetCollectionColor(TAttribute<FSlateColor>(InColor));
+  // Set only invalidates when the value actually changes.
+  CollectionColor.Set(*this, FSlateColor(InColor));
 }
 
 void SUNImage::SetCollectionColor(const TAttribute<FSlateColor>& InColor)
 {
-  SetAttribute(CollectionColor, InColor, EInvalidateWidgetReason::Paint);
+  CollectionColor.Assign(*this, InColor);
 }
 
 void SUNImage::SetFlipForRightToLeftFlowDirection(bool bShouldFlip)
 {
+  // Keep the base flag in sync for parity with the SImage class.
   bFlipForRightToLeftFlowDirection = bShouldFlip;
+  FlipForRightToLeftFlowDirection.Set(*this, bShouldFlip);
 }
 
 END_SLATE_FUNCTION_BUILD_OPTIMIZATION
\ No newline at end of file
@@ -4,12 +4,16 @@
 
 #include "Widgets/Images/SImage.h"
 
+DECLARE_DELEGATE_RetVal(FLinearColor, FOnResolveCollectionColor);
+
 /**
  * @class SUNImage
  * A slate widget class for a UUNImage.
  */
 class UNIQ_API SUNImage : public SImage
 {
+  SLATE_DECLARE_WIDGET(SUNImage, SImage)
+
 public:
   SLATE_BEGIN_ARGS(SUNImage)
     : _CollectionColor(FLinearColor::White)
@@ -20,11 +24,7 @@ public:
 
   SLATE_END_ARGS()
 
-  SUNImage()
-  {
-    SetCanTick(false);
-    bCanSupportFocus = false;
-  }
+  SUNImage();
 
   /** Constructs this widget with InArgs */
   void Construct(const FArguments& InArgs);
@@ -53,8 +53,74 @@ public:
    * @param bShouldFlip If true, the widget flips for right-to-left flow direction.
    */
   void SetFlipForRightToLeftFlowDirection(bool bShouldFlip);
-  
+
+  /**
+   * Sets a resolver that lazily provides the collection color at paint time, in place of the CollectionColor.
+   * While bound, the color is only resolved on the first paint after MarkCollectionColorDirty.
+   * @param InResolver The resolver to use. Pass an unbound delegate to go back to the CollectionColor.
+   */
+  void SetCollectionColorResolver(const FOnResolveCollectionColor& InResolver);
+
+  /**
+   * Marks the resolved collection color as stale. It is resolved again the next time the widget is painted,
+   * so a widget that is not visible does no work at all.
+   */
+  void MarkCollectionColorDirty();
+
+protected:
+  /**
+   * Gets the final color to draw the image with, using the folded tint where possible.
+   * @param ImageBrush The brush being drawn. Must not be null.
+   * @param InWidgetStyle The style the widget is being painted with.
+   * @returns Returns the final color and opacity of the image.
+   */
+  FLinearColor GetFinalColorAndOpacity(const FSlateBrush* ImageBrush, const FWidgetStyle& InWidgetStyle) const;
+
+private:
+  /**
+   * Rebuilds the FoldedTint from the current color inputs.
+   * @param ImageBrush The brush being drawn. Must not be null.
+   */
+  void UpdateFoldedTint(const FSlateBrush* ImageBrush) const;
+
+  /** Marks the FoldedTint as needing a rebuild on the next paint.*/
+  void InvalidateFoldedTint();
+
+  /**
+   * Gets the collection color currently in use, from the resolver if bound, or from the CollectionColor otherwise.
+   * @returns Returns the collection color in use.
+   */
+  FSlateColor GetEffectiveCollectionColor() const;
+
 protected:
-  // A color obtained from a material parameter collection.
-  TAttribute<FSlateColor> CollectionColor;
+  // A color obtained from a material parameter collection. Registered, so global invalidation only polls it when bound.
+  TSlateAttribute<FSlateColor> CollectionColor;
+
+  // If true, the widget flips for right-to-left flow direction. Registered alongside the CollectionColor.
+  TSlateAttribute<bool> FlipForRightToLeftFlowDirection;
+
+private:
+  // The product of the CollectionColor, ColorAndOpacity, and brush tint. Only the widget style is multiplied in at paint.
+  mutable FLinearColor FoldedTint;
+
+  // The brush the FoldedTint was built with.
+  mutable const FSlateBrush* FoldedBrush;
+
+  // The brush tint the FoldedTint was built with.
+  mutable FSlateColor FoldedBrushTint;
+
+  // If true, an input of the FoldedTint has changed, and it must be rebuilt.
+  mutable bool bFoldedTintDirty;
+
+  // If true, no input of the FoldedTint depends on the widget style, and it can be used as-is.
+  mutable bool bFoldedTintIsStyleFree;
+
+  // The resolver for the collection color, used in place of the CollectionColor while bound.
+  FOnResolveCollectionColor CollectionColorResolver;
+
+  // The last color provided by the CollectionColorResolver.
+  mutable FLinearColor ResolvedCollectionColor;
+
+  // If true, the ResolvedCollectionColor is stale, and must be resolved on the next paint.
+  mutable bool bCollectionColorDirty;
 };
\ No newline at end of file
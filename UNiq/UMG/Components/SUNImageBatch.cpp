@@ -0,0 +1,150 @@
+﻿// "Copyright (C) Craig Williams, SlashParadox"
+
+#include "SUNImageBatch.h"
+
+#include "SlateOptMacros.h"
+#include "UNImageBatch.h"
+#include "UNStats.h"
+
+SUNImageBatch::SUNImageBatch()
+  : PrimaryColor(FLinearColor::White)
+  , SecondaryColor(FLinearColor::White)
+  , InstanceBounds(FVector2D::ZeroVector)
+{
+}
+
+BEGIN_SLATE_FUNCTION_BUILD_OPTIMIZATION
+
+void SUNImageBatch::Construct(const FArguments& InArgs)
+{
+}
+
+int32 SUNImageBatch::OnPaint(const FPaintArgs& Args, const FGeometry& AllottedGeometry, const FSlateRect& MyCullingRect,
+  FSlateWindowElementList& OutDrawElements, int32 LayerId, const FWidgetStyle& InWidgetStyle, bool bParentEnabled) const
+{
+  UN_SCOPE_CYCLE_COUNTER(STAT_UNiq_ImagePaint);
+
+  const FSlateBrush* ImageBrush = Image.GetImage().Get();
+
+  if ((ImageBrush == nullptr) || (ImageBrush->DrawAs == ESlateBrushDrawType::NoDrawType) || InstanceColors.IsEmpty())
+    return LayerId;
+
+  const bool bIsEnabled = ShouldBeEnabled(bParentEnabled);
+  const ESlateDrawEffect DrawEffects = bIsEnabled ? ESlateDrawEffect::None : ESlateDrawEffect::DisabledEffect;
+
+  // Everything but the per-instance color is shared, so it is only resolved once for the whole batch.
+  const FLinearColor BatchColorAndOpacity = GetFinalColorAndOpacity(ImageBrush, InWidgetStyle);
+
+  const bool bFlip = FlipForRightToLeftFlowDirection.Get() && GSlateFlowDirection == EFlowDirection::RightToLeft;
+  const FGeometry BatchGeometry = bFlip ? AllottedGeometry.MakeChild(FSlateRenderTransform(FScale2D(-1, 1))) : AllottedGeometry;
+
+  for (int32 i = 0; i < InstanceColors.Num(); ++i)
+  {
+    FSlateDrawElement::MakeBox(OutDrawElements, LayerId, BatchGeometry.ToPaintGeometry(InstanceSizes[i], FSlateLayoutTransform(InstancePositions[i])),
+                               ImageBrush, DrawEffects, BatchColorAndOpacity * InstanceColors[i]);
+  }
+
+  return LayerId;
+}
+
+void SUNImageBatch::SetCollectionColors(const FLinearColor& InPrimary, const FLinearColor& InSecondary)
+{
+  if (PrimaryColor == InPrimary && SecondaryColor == InSecondary)
+    return;
+
+  PrimaryColor = InPrimary;
+  SecondaryColor = InSecondary;
+
+  UpdateInstanceColors();
+  INC_DWORD_STAT(STAT_UNiq_PaintInvalidations);
+  Invalidate(EInvalidateWidgetReason::Paint);
+}
+
+void SUNImageBatch::SetInstances(TArrayView<const FUNImageBatchInstance> InInstances)
+{
+  const int32 NumInstances = InInstances.Num();
+
+  InstancePositions.Reset(NumInstances);
+  InstanceSizes.Reset(NumInstances);
+  InstanceLerpAlphas.Reset(NumInstances);
+
+  for (const FUNImageBatchInstance& Instance : InInstances)
+  {
+    InstancePositions.Add(Instance.Position);
+    InstanceSizes.Add(Instance.Size);
+    InstanceLerpAlphas.Add(Instance.LerpAlpha);
+  }
+
+  UpdateInstanceBounds();
+  UpdateInstanceColors();
+  Invalidate(EInvalidateWidgetReason::Layout);
+}
+
+void SUNImageBatch::AddInstance(const FUNImageBatchInstance& Instance)
+{
+  InstancePositions.Add(Instance.Position);
+  InstanceSizes.Add(Instance.Size);
+  InstanceLerpAlphas.Add(Instance.LerpAlpha);
+  InstanceColors.Add(PrimaryColor + Instance.LerpAlpha * (SecondaryColor - PrimaryColor));
+
+  // Growing the bounds only needs the new instance.
+  InstanceBounds = FVector2D::Max(InstanceBounds, Instance.Position + Instance.Size);
+  Invalidate(EInvalidateWidgetReason::Layout);
+}
+
+void SUNImageBatch::RemoveInstance(int32 InstanceIndex)
+{
+  if (!InstancePositions.IsValidIndex(InstanceIndex))
+    return;
+
+  const FVector2D InstanceExtent = InstancePositions[InstanceIndex] + InstanceSizes[InstanceIndex];
+
+  InstancePositions.RemoveAt(InstanceIndex, 1, false);
+  InstanceSizes.RemoveAt(InstanceIndex, 1, false);
+  InstanceLerpAlphas.RemoveAt(InstanceIndex, 1, false);
+  InstanceColors.RemoveAt(InstanceIndex, 1, false);
+
+  // Only an instance on the edge of the bounds can shrink them.
+  if (InstanceExtent.X >= InstanceBounds.X || InstanceExtent.Y >= InstanceBounds.Y)
+    UpdateInstanceBounds();
+
+  Invalidate(EInvalidateWidgetReason::Layout);
+}
+
+void SUNImageBatch::SetInstanceLerpAlpha(int32 InstanceIndex, float Alpha)
+{
+  if (!InstanceLerpAlphas.IsValidIndex(InstanceIndex) || InstanceLerpAlphas[InstanceIndex] == Alpha)
+    return;
+
+  InstanceLerpAlphas[InstanceIndex] = Alpha;
+  InstanceColors[InstanceIndex] = PrimaryColor + Alpha * (SecondaryColor - PrimaryColor);
+  INC_DWORD_STAT(STAT_UNiq_PaintInvalidations);
+  Invalidate(EInvalidateWidgetReason::Paint);
+}
+
+FVector2D SUNImageBatch::ComputeDesiredSize(float LayoutScaleMultiplier) const
+{
+  return InstanceBounds;
+}
+
+void SUNImageBatch::UpdateInstanceColors()
+{
+  const FLinearColor ColorDelta = SecondaryColor - PrimaryColor;
+
+  InstanceColors.SetNumUninitialized(InstanceLerpAlphas.Num());
+  for (int32 i = 0; i < InstanceLerpAlphas.Num(); ++i)
+  {
+    InstanceColors[i] = PrimaryColor + InstanceLerpAlphas[i] * ColorDelta;
+  }
+}
+
+void SUNImageBatch::UpdateInstanceBounds()
+{
+  InstanceBounds = FVector2D::ZeroVector;
+  for (int32 i = 0; i < InstancePositions.Num(); ++i)
+  {
+    InstanceBounds = FVector2D::Max(InstanceBounds, InstancePositions[i] + InstanceSizes[i]);
+  }
+}
+
+END_SLATE_FUNCTION_BUILD_OPTIMIZATION
\ No newline at end of file
@@ -0,0 +1,99 @@
+﻿// "Copyright (C) Craig Williams, SlashParadox"
+
+#pragma once
+
+#include "SUNImage.h"
+
+struct FUNImageBatchInstance;
+
+/**
+ * @class SUNImageBatch
+ * A slate widget class for a UUNImageBatch. Draws one quad per instance with the image's brush, each
+ * colored by its own lerp between the primary and secondary collection colors.
+ */
+class UNIQ_API SUNImageBatch : public SUNImage
+{
+public:
+  SLATE_BEGIN_ARGS(SUNImageBatch)
+    {
+    }
+
+  SLATE_END_ARGS()
+
+  SUNImageBatch();
+
+  /** Constructs this widget with InArgs */
+  void Construct(const FArguments& InArgs);
+
+public:
+  // Begin SWidget Interface
+  virtual int32 OnPaint(const FPaintArgs& Args, const FGeometry& AllottedGeometry, const FSlateRect& MyCullingRect, FSlateWindowElementList& OutDrawElements, int32 LayerId, const FWidgetStyle& InWidgetStyle, bool bParentEnabled) const override;
+  // End SWidget Interface
+
+public:
+  /**
+   * Sets the primary and secondary collection colors each instance lerps between.
+   * @param InPrimary The primary collection color.
+   * @param InSecondary The secondary collection color.
+   */
+  void SetCollectionColors(const FLinearColor& InPrimary, const FLinearColor& InSecondary);
+
+  /**
+   * Replaces all instances.
+   * @param InInstances The new instances.
+   */
+  void SetInstances(TArrayView<const FUNImageBatchInstance> InInstances);
+
+  /**
+   * Adds a single instance to the end of the batch, without touching the others.
+   * @param Instance The instance to add.
+   */
+  void AddInstance(const FUNImageBatchInstance& Instance);
+
+  /**
+   * Removes a single instance, keeping the order of the others.
+   * @param InstanceIndex The index of the instance.
+   */
+  void RemoveInstance(int32 InstanceIndex);
+
+  /**
+   * Sets the lerp alpha of a single instance.
+   * @param InstanceIndex The index of the instance.
+   * @param Alpha The lerp alpha between the primary and secondary collection colors.
+   */
+  void SetInstanceLerpAlpha(int32 InstanceIndex, float Alpha);
+
+protected:
+  // Begin SWidget Interface
+  virtual FVector2D ComputeDesiredSize(float LayoutScaleMultiplier) const override;
+  // End SWidget Interface
+
+private:
+  /** Recalculates the collection color of every instance.*/
+  void UpdateInstanceColors();
+
+  /** Recalculates the InstanceBounds from every instance.*/
+  void UpdateInstanceBounds();
+
+private:
+  // The primary collection color.
+  FLinearColor PrimaryColor;
+
+  // The secondary collection color.
+  FLinearColor SecondaryColor;
+
+  // The local position of each instance.
+  TArray<FVector2D> InstancePositions;
+
+  // The local size of each instance.
+  TArray<FVector2D> InstanceSizes;
+
+  // The lerp alpha of each instance.
+  TArray<float> InstanceLerpAlphas;
+
+  // The resolved collection color of each instance.
+  TArray<FLinearColor> InstanceColors;
+
+  // The bounds of every instance, used as the desired size.
+  FVector2D InstanceBounds;
+};
\ No newline at end of file
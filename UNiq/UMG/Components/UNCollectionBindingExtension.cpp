@@ -0,0 +1,403 @@
+﻿// "Copyright (C) Craig Williams, SlashParadox"
+
+#include "UNCollectionBindingExtension.h"
+
+#include "Blueprint/UserWidget.h"
+#include "Components/Widget.h"
+#include "Materials/MaterialParameterCollection.h"
+#include "Materials/MaterialParameterCollectionInstance.h"
+#include "Styling/SlateColor.h"
+#include "UNStats.h"
+
+UUNCollectionBindingExtension::UUNCollectionBindingExtension(const FObjectInitializer& ObjectInitializer)
+  : Super(ObjectInitializer)
+  , NextSlot(0)
+  , bSubscribed(false)
+  , bWaitingOnWorldInitialization(false)
+{
+}
+
+void UUNCollectionBindingExtension::BeginDestroy()
+{
+  for (FUNCollectionPropertyBinding& Binding : Bindings)
+  {
+    UnsubscribeBinding(Binding);
+  }
+
+  Super::BeginDestroy();
+}
+
+void UUNCollectionBindingExtension::Construct()
+{
+  Super::Construct();
+
+  bSubscribed = true;
+  for (FUNCollectionPropertyBinding& Binding : Bindings)
+  {
+    SubscribeBinding(Binding);
+    PushBinding(Binding);
+  }
+}
+
+void UUNCollectionBindingExtension::Destruct()
+{
+  // Nothing is shown while destructed, so stop listening until constructed again.
+  bSubscribed = false;
+  for (FUNCollectionPropertyBinding& Binding : Bindings)
+  {
+    UnsubscribeBinding(Binding);
+  }
+
+  Super::Destruct();
+}
+
+bool UUNCollectionBindingExtension::BindWidgetToCollection(UWidget* Widget, const FUNParameterCollectionIndex& Index, EUNCollectionParameterType ParameterType, FName Target)
+{
+  if (!Widget)
+    return false;
+
+  // Widgets in a widget tree are outered to their UUserWidget. A UUserWidget on its own binds to itself.
+  UUserWidget* UserWidget = Widget->GetTypedOuter<UUserWidget>();
+  if (!UserWidget)
+    UserWidget = Cast<UUserWidget>(Widget);
+
+  if (!UserWidget)
+  {
+    UE_LOG(LogSlate, Warning, TEXT("[%s] [%s] Widget is not in a user widget!"), *FString(__FUNCTION__), *GetNameSafe(Widget));
+    return false;
+  }
+
+  UUNCollectionBindingExtension* Extension = UserWidget->GetExtension<UUNCollectionBindingExtension>();
+  if (!Extension)
+    Extension = UserWidget->AddExtension<UUNCollectionBindingExtension>();
+
+  FUNCollectionPropertyBinding Binding;
+  Binding.Widget = Widget;
+  Binding.Index = Index;
+  Binding.ParameterType = ParameterType;
+  Binding.Target = Target;
+
+  return Extension && Extension->AddBinding(Binding);
+}
+
+void UUNCollectionBindingExtension::UnbindWidgetFromCollection(UWidget* Widget)
+{
+  if (!Widget)
+    return;
+
+  UUserWidget* UserWidget = Widget->GetTypedOuter<UUserWidget>();
+  if (!UserWidget)
+    UserWidget = Cast<UUserWidget>(Widget);
+
+  if (UUNCollectionBindingExtension* Extension = UserWidget ? UserWidget->GetExtension<UUNCollectionBindingExtension>() : nullptr)
+    Extension->RemoveBindings(Widget);
+}
+
+bool UUNCollectionBindingExtension::AddBinding(const FUNCollectionPropertyBinding& Binding)
+{
+  // Only the authored settings are taken. Any state copied along with them belongs to another binding.
+  FUNCollectionPropertyBinding NewBinding;
+  NewBinding.Widget = Binding.Widget;
+  NewBinding.Index = Binding.Index;
+  NewBinding.ParameterType = Binding.ParameterType;
+  NewBinding.Target = Binding.Target;
+
+  if (!NewBinding.Widget || NewBinding.Index.ParameterName == NAME_None || !ResolveTarget(NewBinding))
+    return false;
+
+  NewBinding.Slot = NextSlot++;
+
+  // Bindings added before construction are subscribed along with the rest once it happens.
+  FUNCollectionPropertyBinding& AddedBinding = Bindings.Add_GetRef(MoveTemp(NewBinding));
+  if (bSubscribed)
+  {
+    SubscribeBinding(AddedBinding);
+    PushBinding(AddedBinding);
+  }
+
+  return true;
+}
+
+void UUNCollectionBindingExtension::RemoveBindings(const UWidget* Widget)
+{
+  for (int32 i = Bindings.Num() - 1; i >= 0; --i)
+  {
+    if (Bindings[i].Widget != Widget)
+      continue;
+
+    UnsubscribeBinding(Bindings[i]);
+    Bindings.RemoveAt(i, 1, false);
+  }
+}
+
+void UUNCollectionBindingExtension::OnCollectionVectorUpdated(int32 Slot, const FLinearColor& InValue)
+{
+  if (FUNCollectionPropertyBinding* Binding = FindBinding(Slot))
+  {
+    Binding->Value = InValue;
+    Binding->bHasValue = true;
+  }
+}
+
+void UUNCollectionBindingExtension::OnCollectionScalarUpdated(int32 Slot, float InValue)
+{
+  if (FUNCollectionPropertyBinding* Binding = FindBinding(Slot))
+  {
+    Binding->Value = FLinearColor(InValue, 0.0f, 0.0f, 0.0f);
+    Binding->bHasValue = true;
+  }
+}
+
+void UUNCollectionBindingExtension::OnCollectionUpdatesApplied()
+{
+  // Bindings that weren't updated still hold their pushed value, so they are skipped.
+  for (FUNCollectionPropertyBinding& Binding : Bindings)
+  {
+    PushBinding(Binding);
+  }
+}
+
+void UUNCollectionBindingExtension::OnCollectionWorldInitialized(UWorld* World)
+{
+  bWaitingOnWorldInitialization = false;
+  if (!bSubscribed)
+    return;
+
+  for (FUNCollectionPropertyBinding& Binding : Bindings)
+  {
+    SubscribeBinding(Binding);
+    PushBinding(Binding);
+  }
+}
+
+void UUNCollectionBindingExtension::OnCollectionWorldCleanedUp(UWorld* World)
+{
+  // Nothing was subscribed. Constructing again in another world queues this extension again.
+  bWaitingOnWorldInitialization = false;
+}
+
+void UUNCollectionBindingExtension::OnCollectionSubscriptionsReleased()
+{
+  // The handles belonged to the old subsystem's table. Everything is subscribed again on the next construction.
+  for (FUNCollectionPropertyBinding& Binding : Bindings)
+  {
+    Binding.ParameterHandle = INDEX_NONE;
+    Binding.SubscribedInstance.Reset();
+    Binding.SubscribedName = NAME_None;
+  }
+
+  CollectionSubsystem.Reset();
+}
+
+bool UUNCollectionBindingExtension::ResolveTarget(FUNCollectionPropertyBinding& Binding)
+{
+  Binding.Setter = nullptr;
+  Binding.ValueProperty = nullptr;
+
+  // Setters are found by their own name, or by the property they set.
+  UFunction* Setter = Binding.Widget->FindFunction(Binding.Target);
+  if (!Setter)
+    Setter = Binding.Widget->FindFunction(*FString::Printf(TEXT("Set%s"), *Binding.Target.ToString()));
+
+  if (Setter)
+  {
+    // Only setters that take exactly the value, and return nothing, can be called with it.
+    FProperty* Parameter = Setter->NumParms == 1 ? CastField<FProperty>(Setter->ChildProperties) : nullptr;
+    if (Parameter && !Parameter->HasAnyPropertyFlags(CPF_ReturnParm | CPF_OutParm) && CanWriteValue(Parameter, Binding.ParameterType))
+    {
+      Binding.Setter = Setter;
+      Binding.ValueProperty = Parameter;
+      return true;
+    }
+  }
+
+  FProperty* Property = FindFProperty<FProperty>(Binding.Widget->GetClass(), Binding.Target);
+  if (Property && CanWriteValue(Property, Binding.ParameterType))
+  {
+    // This works, but every change synchronizes every property of the widget, so point at a setter if there is one.
+    UE_LOG(LogSlate, Warning, TEXT("[%s] [%s] No setter found, so the property is set directly and the whole widget is synchronized on every change! Widget: [%s] Target: [%s]"), *FString(__FUNCTION__), *GetNameSafe(Binding.Widget->GetTypedOuter<UUserWidget>()), *GetNameSafe(Binding.Widget), *Binding.Target.ToString());
+
+    Binding.ValueProperty = Property;
+    return true;
+  }
+
+  UE_LOG(LogSlate, Warning, TEXT("[%s] [%s] No setter or property found that takes the parameter! Widget: [%s] Target: [%s]"), *FString(__FUNCTION__), *GetNameSafe(Binding.Widget->GetTypedOuter<UUserWidget>()), *GetNameSafe(Binding.Widget), *Binding.Target.ToString());
+  return false;
+}
+
+bool UUNCollectionBindingExtension::CanWriteValue(const FProperty* Property, EUNCollectionParameterType ParameterType)
+{
+  if (Property->ArrayDim != 1)
+    return false;
+
+  if (ParameterType == EUNCollectionParameterType::Scalar)
+  {
+    const FNumericProperty* NumericProperty = CastField<FNumericProperty>(Property);
+    return NumericProperty && NumericProperty->IsFloatingPoint();
+  }
+
+  const FStructProperty* StructProperty = CastField<FStructProperty>(Property);
+  if (!StructProperty)
+    return false;
+
+  const UScriptStruct* Struct = StructProperty->Struct;
+  return Struct == TBaseStructure<FLinearColor>::Get() || Struct == FSlateColor::StaticStruct()
+    || Struct == TBaseStructure<FColor>::Get() || Struct == TBaseStructure<FVector4>::Get();
+}
+
+void UUNCollectionBindingExtension::WriteValue(const FProperty* Property, void* ValuePtr, const FLinearColor& Value)
+{
+  if (const FNumericProperty* NumericProperty = CastField<FNumericProperty>(Property))
+  {
+    NumericProperty->SetFloatingPointPropertyValue(ValuePtr, static_cast<double>(Value.R));
+    return;
+  }
+
+  const UScriptStruct* Struct = CastFieldChecked<FStructProperty>(Property)->Struct;
+
+  if (Struct == TBaseStructure<FLinearColor>::Get())
+    *static_cast<FLinearColor*>(ValuePtr) = Value;
+  else if (Struct == FSlateColor::StaticStruct())
+    *static_cast<FSlateColor*>(ValuePtr) = FSlateColor(Value);
+  else if (Struct == TBaseStructure<FColor>::Get())
+    *static_cast<FColor*>(ValuePtr) = Value.ToFColor(true);
+  else
+    *static_cast<FVector4*>(ValuePtr) = FVector4(Value.R, Value.G, Value.B, Value.A);
+}
+
+void UUNCollectionBindingExtension::SubscribeBinding(FUNCollectionPropertyBinding& Binding)
+{
+  UUNCollectionSubsystem* Subsystem = GetCollectionSubsystem();
+  const UUserWidget* UserWidget = GetUserWidget();
+  UWorld* World = UserWidget ? UserWidget->GetWorld() : nullptr;
+  if (!Subsystem || !World)
+    return;
+
+  // Instances only exist once the world is initialized. Every binding is subscribed again once it is.
+  if (World->bIsWorldInitialized == 0)
+  {
+    if (!bWaitingOnWorldInitialization)
+    {
+      bWaitingOnWorldInitialization = true;
+      UUNCollectionSubsystem::QueueForWorldInitialization(World, this, this);
+    }
+
+    return;
+  }
+
+  const TSoftObjectPtr<UMaterialParameterCollection>& SoftCollection = Binding.Index.Collection;
+  if (!SoftCollection.IsNull() && !SoftCollection.IsValid())
+    INC_DWORD_STAT(STAT_UNiq_SynchronousLoads);
+
+  const UMaterialParameterCollection* Collection = SoftCollection.LoadSynchronous();
+  UMaterialParameterCollectionInstance* Instance = Subsystem->GetCollectionInstance(Collection);
+  if (!Instance)
+    return;
+
+  if (Binding.ParameterType == EUNCollectionParameterType::Vector)
+  {
+    if (Subsystem->GetParameterTable().Matches(Binding.ParameterHandle, TObjectKey<UMaterialParameterCollectionInstance>(Instance), Binding.Index.ParameterName))
+      return;
+
+    UnsubscribeBinding(Binding);
+
+    if (!Binding.Index.ResolveVectorParameter(Collection))
+    {
+      UE_LOG(LogSlate, Warning, TEXT("[%s] [%s] Parameter not found in collection! Collection: [%s] Parameter: [%s]"), *FString(__FUNCTION__), *GetNameSafe(UserWidget), *GetNameSafe(Collection), *Binding.Index.ParameterName.ToString());
+      return;
+    }
+
+    // The value is in the shared parameter table, read once per parameter no matter how many bind to it.
+    Binding.ParameterHandle = Subsystem->SubscribeVector(Instance, Binding.Index.ParameterName, this, this, Binding.Slot);
+    if (Binding.ParameterHandle == INDEX_NONE)
+      return;
+
+    Binding.Value = Subsystem->GetParameterTable().GetValue(Binding.ParameterHandle);
+    Binding.bHasValue = true;
+    return;
+  }
+
+  if (Binding.SubscribedInstance == Instance && Binding.SubscribedName == Binding.Index.ParameterName)
+    return;
+
+  UnsubscribeBinding(Binding);
+
+  const FCollectionScalarParameter* Parameter = Binding.Index.ResolveScalarParameter(Collection);
+  if (!Parameter)
+  {
+    UE_LOG(LogSlate, Warning, TEXT("[%s] [%s] Scalar parameter not found in collection! Collection: [%s] Parameter: [%s]"), *FString(__FUNCTION__), *GetNameSafe(UserWidget), *GetNameSafe(Collection), *Binding.Index.ParameterName.ToString());
+    return;
+  }
+
+  Subsystem->SubscribeScalar(Instance, Binding.Index.ParameterName, this, this, Binding.Slot);
+  Binding.SubscribedInstance = Instance;
+  Binding.SubscribedName = Binding.Index.ParameterName;
+
+  float ScalarValue = 0.0f;
+  if (!Instance->GetScalarParameterValue(*Parameter, ScalarValue))
+    ScalarValue = Parameter->DefaultValue;
+
+  Binding.Value = FLinearColor(ScalarValue, 0.0f, 0.0f, 0.0f);
+  Binding.bHasValue = true;
+}
+
+void UUNCollectionBindingExtension::UnsubscribeBinding(FUNCollectionPropertyBinding& Binding)
+{
+  UUNCollectionSubsystem* Subsystem = CollectionSubsystem.Get();
+
+  if (Subsystem && Binding.ParameterHandle != INDEX_NONE)
+    Subsystem->UnsubscribeVector(Binding.ParameterHandle, this, Binding.Slot);
+
+  if (Subsystem && Binding.SubscribedInstance.IsValid())
+    Subsystem->UnsubscribeScalar(Binding.SubscribedInstance.Get(), Binding.SubscribedName, this, Binding.Slot);
+
+  Binding.ParameterHandle = INDEX_NONE;
+  Binding.SubscribedInstance.Reset();
+  Binding.SubscribedName = NAME_None;
+}
+
+void UUNCollectionBindingExtension::PushBinding(FUNCollectionPropertyBinding& Binding)
+{
+  UWidget* Widget = Binding.Widget;
+  if (!Widget || !Binding.bHasValue || !Binding.ValueProperty)
+    return;
+
+  // Pushing the same value would still invalidate the widget, so only changes are pushed.
+  if (Binding.bHasPushedValue && Binding.PushedValue == Binding.Value)
+    return;
+
+  Binding.PushedValue = Binding.Value;
+  Binding.bHasPushedValue = true;
+
+  if (!Binding.Setter)
+  {
+    // A property set directly is only shown once the widget synchronizes it to slate.
+    WriteValue(Binding.ValueProperty, Binding.ValueProperty->ContainerPtrToValuePtr<void>(Widget), Binding.Value);
+    Widget->SynchronizeProperties();
+    return;
+  }
+
+  uint8* Parameters = static_cast<uint8*>(FMemory_Alloca_Aligned(Binding.Setter->ParmsSize, Binding.Setter->GetMinAlignment()));
+  Binding.ValueProperty->InitializeValue_InContainer(Parameters);
+  WriteValue(Binding.ValueProperty, Binding.ValueProperty->ContainerPtrToValuePtr<void>(Parameters), Binding.Value);
+
+  Widget->ProcessEvent(Binding.Setter, Parameters);
+  Binding.ValueProperty->DestroyValue_InContainer(Parameters);
+}
+
+FUNCollectionPropertyBinding* UUNCollectionBindingExtension::FindBinding(int32 Slot)
+{
+  // Each UUserWidget only has a handful of bindings, so a search beats keeping a map in step.
+  return Bindings.FindByPredicate([Slot](const FUNCollectionPropertyBinding& Binding) { return Binding.Slot == Slot; });
+}
+
+UUNCollectionSubsystem* UUNCollectionBindingExtension::GetCollectionSubsystem() const
+{
+  if (!CollectionSubsystem.IsValid())
+  {
+    const UUserWidget* UserWidget = GetUserWidget();
+    CollectionSubsystem = UUNCollectionSubsystem::Get(UserWidget ? UserWidget->GetWorld() : nullptr);
+  }
+
+  return CollectionSubsystem.Get();
+}
\ No newline at end of file
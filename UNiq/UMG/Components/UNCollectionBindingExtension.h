@@ -0,0 +1,233 @@
+﻿// "Copyright (C) Craig Williams, SlashParadox"
+
+#pragma once
+
+#include "Extensions/UserWidgetExtension.h"
+#include "UNImage.h"
+
+#include "UNCollectionBindingExtension.generated.h"
+
+class UWidget;
+
+/**
+ * @enum EUNCollectionParameterType
+ * @brief The kind of collection parameter a binding pushes.
+ */
+UENUM(BlueprintType)
+enum class EUNCollectionParameterType : uint8
+{
+  // A vector parameter. Pushed into FLinearColor, FSlateColor, FColor, and FVector4 values.
+  Vector,
+
+  // A scalar parameter. Pushed into float and double values.
+  Scalar
+};
+
+/**
+ * @struct FUNCollectionPropertyBinding
+ * @brief A single collection parameter pushed into a widget, through a setter function or straight into a property.
+ */
+USTRUCT(BlueprintType)
+struct FUNCollectionPropertyBinding
+{
+  GENERATED_BODY()
+
+  FUNCollectionPropertyBinding()
+    : ParameterType(EUNCollectionParameterType::Vector)
+    , Slot(INDEX_NONE)
+    , ParameterHandle(INDEX_NONE)
+    , Value(ForceInitToZero)
+    , PushedValue(ForceInitToZero)
+    , bHasValue(false)
+    , bHasPushedValue(false)
+    , Setter(nullptr)
+    , ValueProperty(nullptr)
+  {
+  }
+
+  // The widget to push the parameter into.
+  UPROPERTY(EditAnywhere, BlueprintReadWrite)
+  TObjectPtr<UWidget> Widget;
+
+  // The collection parameter to push.
+  UPROPERTY(EditAnywhere, BlueprintReadWrite)
+  FUNParameterCollectionIndex Index;
+
+  // The kind of parameter the Index refers to.
+  UPROPERTY(EditAnywhere, BlueprintReadWrite)
+  EUNCollectionParameterType ParameterType;
+
+  // The setter function to call with the value, such as SetColorAndOpacity. If the Widget has no such function,
+  // "Set" is prefixed to it, and failing that, it names a property that is set directly. Setting a property is
+  // warned about, as the whole widget is synchronized each time.
+  UPROPERTY(EditAnywhere, BlueprintReadWrite)
+  FName Target;
+
+  // The subscription slot of the binding. Unique within its extension.
+  int32 Slot;
+
+  // The parameter table handle of a vector subscription.
+  int32 ParameterHandle;
+
+  // The instance of a scalar subscription.
+  TWeakObjectPtr<UMaterialParameterCollectionInstance> SubscribedInstance;
+
+  // The parameter name of a scalar subscription.
+  FName SubscribedName;
+
+  // The latest value of the parameter. Scalars are in R.
+  FLinearColor Value;
+
+  // The value last pushed into the Widget.
+  FLinearColor PushedValue;
+
+  // If true, the Value has been read from the collection.
+  bool bHasValue;
+
+  // If true, the PushedValue has been pushed into the Widget.
+  bool bHasPushedValue;
+
+  // The resolved setter function of the Target. Null if the Target is a property.
+  UFunction* Setter;
+
+  // The resolved parameter of the Setter, or the resolved property of the Target.
+  FProperty* ValueProperty;
+};
+
+/**
+ * @class UUNCollectionBindingExtension
+ * @brief Pushes collection parameters into the widgets of a UUserWidget, only when a parameter changes. This is
+ * the push-based binding UUNImage uses for its colors, generalized to any setter or property of any widget, so
+ * text, border, and progress bar colors don't need per-frame function bindings. Setters are preferred, as a
+ * property set directly is only shown after synchronizing every property of the widget.
+ * Add bindings through BindWidgetToCollection, which adds the extension to the widget's UUserWidget as needed.
+ */
+UCLASS()
+class UNIQ_API UUNCollectionBindingExtension : public UUserWidgetExtension, public FUNCollectionListener
+{
+  GENERATED_UCLASS_BODY()
+
+public:
+  // Begin UObject Interface
+  virtual void BeginDestroy() override;
+  // End UObject Interface
+
+  // Begin UUserWidgetExtension Interface
+  virtual void Construct() override;
+  virtual void Destruct() override;
+  // End UUserWidgetExtension Interface
+
+  /**
+   * Binds a property of a widget to a collection parameter. The value is pushed once the widget's UUserWidget is
+   * constructed, and again each time the parameter changes.
+   * @param Widget The widget to push into. Must be in a UUserWidget, or be one.
+   * @param Index The collection parameter to push.
+   * @param ParameterType The kind of parameter the Index refers to.
+   * @param Target The setter function or property to push into. See FUNCollectionPropertyBinding::Target.
+   * @returns Returns true if the binding was added.
+   */
+  UFUNCTION(BlueprintCallable, BlueprintCosmetic, Category = "Collection Binding")
+  static bool BindWidgetToCollection(UWidget* Widget, const FUNParameterCollectionIndex& Index, EUNCollectionParameterType ParameterType, FName Target);
+
+  /**
+   * Removes every collection binding of a widget.
+   * @param Widget The widget to unbind.
+   */
+  UFUNCTION(BlueprintCallable, BlueprintCosmetic, Category = "Collection Binding")
+  static void UnbindWidgetFromCollection(UWidget* Widget);
+
+  /**
+   * Adds a binding, pushing its current value if the UUserWidget is constructed.
+   * @param Binding The binding to add.
+   * @returns Returns true if the binding's Target could be resolved, and it was added.
+   */
+  bool AddBinding(const FUNCollectionPropertyBinding& Binding);
+
+  /**
+   * Removes every binding of a widget.
+   * @param Widget The widget to unbind.
+   */
+  void RemoveBindings(const UWidget* Widget);
+
+protected:
+  // Begin FUNCollectionListener Interface
+  virtual void OnCollectionVectorUpdated(int32 Slot, const FLinearColor& InValue) override;
+  virtual void OnCollectionScalarUpdated(int32 Slot, float InValue) override;
+  virtual void OnCollectionUpdatesApplied() override;
+  virtual void OnCollectionWorldInitialized(UWorld* World) override;
+  virtual void OnCollectionWorldCleanedUp(UWorld* World) override;
+  virtual void OnCollectionSubscriptionsReleased() override;
+  // End FUNCollectionListener Interface
+
+private:
+  /**
+   * Resolves the setter function or property of a binding's Target.
+   * @param Binding The binding to resolve.
+   * @returns Returns true if the Target can take the binding's kind of parameter.
+   */
+  static bool ResolveTarget(FUNCollectionPropertyBinding& Binding);
+
+  /**
+   * Checks if a property can take a kind of parameter.
+   * @param Property The property to check.
+   * @param ParameterType The kind of parameter.
+   * @returns Returns true if WriteValue supports the property.
+   */
+  static bool CanWriteValue(const FProperty* Property, EUNCollectionParameterType ParameterType);
+
+  /**
+   * Writes a parameter value into a property, converting it to the property's type.
+   * @param Property The property to write. Must pass CanWriteValue.
+   * @param ValuePtr The property's value.
+   * @param Value The parameter value. Scalars are in R.
+   */
+  static void WriteValue(const FProperty* Property, void* ValuePtr, const FLinearColor& Value);
+
+  /**
+   * Subscribes a binding to its parameter, and reads its current value.
+   * @param Binding The binding to subscribe.
+   */
+  void SubscribeBinding(FUNCollectionPropertyBinding& Binding);
+
+  /**
+   * Unsubscribes a binding from its parameter.
+   * @param Binding The binding to unsubscribe.
+   */
+  void UnsubscribeBinding(FUNCollectionPropertyBinding& Binding);
+
+  /**
+   * Pushes a binding's value into its widget, if it changed since the last push.
+   * @param Binding The binding to push.
+   */
+  void PushBinding(FUNCollectionPropertyBinding& Binding);
+
+  /**
+   * Finds a binding by its slot.
+   * @param Slot The slot of the binding.
+   * @returns Returns the binding, if any.
+   */
+  FUNCollectionPropertyBinding* FindBinding(int32 Slot);
+
+  /**
+   * Gets the collection subsystem of the extension's world, caching it.
+   * @returns Returns the subsystem, if any.
+   */
+  UUNCollectionSubsystem* GetCollectionSubsystem() const;
+
+private:
+  // Every binding of the UUserWidget's widgets.
+  UPROPERTY(Transient)
+  TArray<FUNCollectionPropertyBinding> Bindings;
+
+  // The cached collection subsystem.
+  mutable TWeakObjectPtr<UUNCollectionSubsystem> CollectionSubsystem;
+
+  // The slot of the next added binding.
+  int32 NextSlot;
+
+  // If true, the UUserWidget is constructed, and the bindings are subscribed.
+  bool bSubscribed;
+
+  // If true, the extension is queued to subscribe once the world is initialized.
+  bool bWaitingOnWorldInitialization;
+};
\ No newline at end of file
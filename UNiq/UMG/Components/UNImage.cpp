@@ -3,18 +3,62 @@
 #include "UNImage.h"
 
 #include "SUNImage.h"
+#include "UNStats.h"
+#include "UNUpdateRecording.h"
 #include "Materials/MaterialParameterCollection.h"
 #include "Materials/MaterialParameterCollectionInstance.h"
 
 UUNImage::UUNImage(const FObjectInitializer& ObjectInitializer)
   : Super(ObjectInitializer)
   , CollectionLerpAlpha(0.0f)
+  , bLoadCollectionsAsync(false)
+  , AsyncPlaceholderColor(FLinearColor::Transparent)
+  , CollectionColorTolerance(EUNColorChangeTolerance::Exact)
+  , bResolveCollectionColorOnPaint(false)
+  , GradientLUTResolution(64)
+  , bGradientLUTDirty(true)
+  , CachedCollectionColor(FLinearColor::White)
+  , bWaitingOnCollections(false)
+  , bWaitingOnWorldInitialization(false)
+  , bColorDataInitialized(false)
 {
 }
 
+void UUNImage::BeginDestroy()
+{
+  SubscribeColorData(PrimaryCollectionColor, nullptr, true);
+  SubscribeColorData(SecondaryCollectionColor, nullptr, false);
+
+  for (int32 i = 0; i < GradientColorData.Num(); ++i)
+  {
+    SubscribeColorDataToSlot(GradientColorData[i], nullptr, GradientSlotOffset + i);
+  }
+
+  SubscribeScalarData(OpacityCollectionScalar, nullptr, OpacityScalarSlot);
+  SubscribeScalarData(LerpAlphaCollectionScalar, nullptr, LerpAlphaScalarSlot);
+
+  RemoveFromColorPool();
+
+  Super::BeginDestroy();
+}
+
+#if WITH_EDITOR
+void UUNImage::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+  Super::PostEditChangeProperty(PropertyChangedEvent);
+
+  // The lookup table is only rebuilt when dirty, so a new resolution would otherwise keep the old samples.
+  if (PropertyChangedEvent.GetMemberPropertyName() == GET_MEMBER_NAME_CHECKED(ThisClass, GradientLUTResolution))
+  {
+    bGradientLUTDirty = true;
+    CalculateCachedCollectionColor();
+  }
+}
+#endif
+
 TSharedRef<SWidget> UUNImage::RebuildWidget()
 {
-  MyUNImage = SNew(SUNImage);
+  MyUNImage = ConstructUNImage();
   MyImage = MyUNImage;
   MyUNImage->SetFlipForRightToLeftFlowDirection(bFlipForRightToLeftFlowDirection);
   
@@ -25,10 +69,21 @@ TSharedRef<SWidget> UUNImage::RebuildWidget()
     return MyUNImage.ToSharedRef();
   }
   
-  // If the world is not yet initialized, bind to it to initialize.
+  // If the world is not yet initialized, queue up to initialize alongside every other waiting widget.
   if (World->bIsWorldInitialized == 0)
   {
-    FWorldDelegates::OnPostWorldInitialization.AddUObject(this, &ThisClass::OnWorldInitialized);
+    if (!bWaitingOnWorldInitialization)
+    {
+      bWaitingOnWorldInitialization = true;
+      UUNCollectionSubsystem::QueueForWorldInitialization(World, this, this);
+    }
+  }
+  else if (CanReuseColorData())
+  {
+    // The bindings outlived the old slate widget, and kept the cached colors current. Only the new widget needs them.
+    // An unchanged color skips the slate update, so the cached color is pushed into the new widget explicitly.
+    CalculateCachedCollectionColor();
+    MyUNImage->SetCollectionColor(CachedCollectionColor);
   }
   else
   {
@@ -45,6 +100,14 @@ void UUNImage::SynchronizeProperties()
   if (MyUNImage.IsValid())
   {
     MyUNImage->SetCollectionColor(CachedCollectionColor);
+
+    if (ShouldResolveCollectionColorOnPaint())
+    {
+      RemoveFromColorPool();
+      MyUNImage->SetCollectionColorResolver(FOnResolveCollectionColor::CreateUObject(this, &ThisClass::ResolveCollectionColorOnPaint));
+    }
+    else
+      MyUNImage->SetCollectionColorResolver(FOnResolveCollectionColor());
   }
 }
 
@@ -52,6 +115,7 @@ void UUNImage::ReleaseSlateResources(bool bReleaseChildren)
 {
   Super::ReleaseSlateResources(bReleaseChildren);
 
+  RemoveFromColorPool();
   MyUNImage.Reset();
   MyImage.Reset();
 }
@@ -71,14 +135,22 @@ void UUNImage::SetCollectionColorCollection(const UMaterialParameterCollection*
   if (ColorData.Index.Collection != Collection)
   {
     RebindColorData(ColorData, Collection, bIsPrimary);
-    ReCacheColorDataColor(ColorData);
+    ResolveColorDataParameter(ColorData);
     CalculateCachedCollectionColor();
   }
 }
 
 void UUNImage::SetCollectionColorSoftCollection(const TSoftObjectPtr<UMaterialParameterCollection>& Collection, bool bIsPrimary)
 {
-  SetCollectionColorCollection(Collection.LoadSynchronous(), bIsPrimary);
+  FUNCollectionColorData& ColorData = bIsPrimary ? PrimaryCollectionColor : SecondaryCollectionColor;
+
+  if (ColorData.Index.Collection != Collection && RequestCollectionLoad(Collection))
+  {
+    WaitOnColorDataCollection(ColorData, Collection, bIsPrimary);
+    return;
+  }
+
+  SetCollectionColorCollection(LoadCollection(Collection), bIsPrimary);
 }
 
 void UUNImage::SetCollectionColorName(const FName& ParameterName, bool bIsPrimary)
@@ -87,15 +159,96 @@ void UUNImage::SetCollectionColorName(const FName& ParameterName, bool bIsPrimar
 
   if (ParameterName != NAME_None && ColorData.Index.ParameterName != ParameterName)
   {
-    ReCacheColorDataColor(ColorData, ParameterName);
+    UMaterialParameterCollectionInstance* Instance = GetSubscribedInstance(ColorData);
+    ResolveColorDataParameter(ColorData, ParameterName);
+    SubscribeColorData(ColorData, Instance, bIsPrimary);
     CalculateCachedCollectionColor();
   }
 }
 
 void UUNImage::SetCollectionLerpAlpha(float Alpha)
 {
+  // The bound scalar owns the alpha. Anything set here would be overwritten by its next update anyway.
+  if (IsCollectionLerpAlphaBound())
+    return;
+
   CollectionLerpAlpha = Alpha;
   CalculateCachedCollectionColor();
+
+  if (FUNUpdateRecorder* Recorder = FUNUpdateRecorder::GetActive())
+    Recorder->RecordImageLerpAlpha(this, Alpha);
+}
+
+void UUNImage::TweenCollectionLerpAlpha(float TargetAlpha, float Duration, EUNTweenEasing Easing, float EasingExponent)
+{
+  if (IsCollectionLerpAlphaBound())
+  {
+    StopCollectionLerpAlphaTween();
+    return;
+  }
+
+  UUNTweenSubsystem* TweenSubsystem = UUNTweenSubsystem::Get(GetWorld());
+  if (!TweenSubsystem)
+  {
+    SetCollectionLerpAlpha(TargetAlpha);
+    return;
+  }
+
+  TweenSubsystem->TweenLerpAlpha(this, TargetAlpha, Duration, Easing, EasingExponent);
+}
+
+void UUNImage::StopCollectionLerpAlphaTween()
+{
+  if (UUNTweenSubsystem* TweenSubsystem = UUNTweenSubsystem::Get(GetWorld()))
+    TweenSubsystem->StopLerpAlphaTween(this);
+}
+
+void UUNImage::SetCollectionGradient(const TArray<FUNCollectionGradientStop>& Stops)
+{
+  CollectionGradient = Stops;
+
+  bool bAnyLoading = false;
+  for (const FUNCollectionGradientStop& Stop : CollectionGradient)
+  {
+    bAnyLoading |= RequestCollectionLoad(Stop.Index.Collection);
+  }
+
+  // Initializing again once the loads finish picks up the new stops.
+  if (bAnyLoading)
+  {
+    bWaitingOnCollections = true;
+    CalculateCachedCollectionColor();
+    return;
+  }
+
+  UpdateGradientColorData();
+  CalculateCachedCollectionColor();
+}
+
+void UUNImage::ClearCollectionGradient()
+{
+  SetCollectionGradient(TArray<FUNCollectionGradientStop>());
+}
+
+void UUNImage::SetGradientLUTResolution(int32 Resolution)
+{
+  Resolution = FMath::Clamp(Resolution, 2, 1024);
+  if (GradientLUTResolution == Resolution)
+    return;
+
+  GradientLUTResolution = Resolution;
+  bGradientLUTDirty = true;
+  CalculateCachedCollectionColor();
+}
+
+void UUNImage::SetOpacityCollectionScalar(const FUNParameterCollectionIndex& Index)
+{
+  UpdateScalarData(OpacityCollectionScalar, Index, OpacityScalarSlot);
+}
+
+void UUNImage::SetLerpAlphaCollectionScalar(const FUNParameterCollectionIndex& Index)
+{
+  UpdateScalarData(LerpAlphaCollectionScalar, Index, LerpAlphaScalarSlot);
 }
 
 void UUNImage::SetCollectionColorIndexBP(FUNParameterCollectionIndex Index, bool bIsPrimary)
@@ -120,102 +273,598 @@ void UUNImage::SetCollectionColorNameBP(FName ParameterName, bool bIsPrimary)
 
 void UUNImage::CalculateCachedCollectionColor()
 {
-  CachedCollectionColor = PrimaryCollectionColor.CachedColor + CollectionLerpAlpha * (SecondaryCollectionColor.CachedColor - PrimaryCollectionColor.CachedColor);
+  UN_SCOPE_CYCLE_COUNTER(STAT_UNiq_CalculateCachedCollectionColor);
+
+  // Defer the work to the next paint, which never comes while the image is not visible.
+  if (MyUNImage.IsValid() && ShouldResolveCollectionColorOnPaint())
+  {
+    MyUNImage->MarkCollectionColorDirty();
+    return;
+  }
+
+  const FLinearColor NewColor = ComputeCollectionColor();
+  UpdateColorPoolEntry(NewColor);
+
+  // Skip the slate update entirely, so an unchanged color never invalidates the widget.
+  if (IsCollectionColorUnchanged(NewColor))
+    return;
+
+  CachedCollectionColor = NewColor;
 
   if (MyUNImage.IsValid())
     MyUNImage->SetCollectionColor(CachedCollectionColor);
 }
 
+FLinearColor UUNImage::ComputeCollectionColor() const
+{
+  if (bWaitingOnCollections)
+    return AsyncPlaceholderColor;
+
+  if (UsesCollectionGradient())
+    return SampleCollectionGradient(CollectionLerpAlpha);
+
+  const FLinearColor PrimaryColor = GetColorDataColor(PrimaryCollectionColor);
+  const FLinearColor SecondaryColor = GetColorDataColor(SecondaryCollectionColor);
+  return PrimaryColor + CollectionLerpAlpha * (SecondaryColor - PrimaryColor);
+}
+
+TSharedRef<SUNImage> UUNImage::ConstructUNImage()
+{
+  return SNew(SUNImage);
+}
+
+void UUNImage::GetResolvedCollectionColors(FLinearColor& OutPrimary, FLinearColor& OutSecondary) const
+{
+  OutPrimary = bWaitingOnCollections ? AsyncPlaceholderColor : GetColorDataColor(PrimaryCollectionColor);
+  OutSecondary = bWaitingOnCollections ? AsyncPlaceholderColor : GetColorDataColor(SecondaryCollectionColor);
+}
+
+FLinearColor UUNImage::SampleCollectionGradient(float Alpha) const
+{
+  if (bGradientLUTDirty)
+    RebuildGradientLUT();
+
+  const float Sample = FMath::Clamp(Alpha, 0.0f, 1.0f) * static_cast<float>(GradientLUT.Num() - 1);
+  const int32 LowerSample = FMath::Min(FMath::FloorToInt32(Sample), GradientLUT.Num() - 2);
+  return FMath::Lerp(GradientLUT[LowerSample], GradientLUT[LowerSample + 1], Sample - static_cast<float>(LowerSample));
+}
+
+bool UUNImage::IsCollectionColorUnchanged(const FLinearColor& Color) const
+{
+  switch (CollectionColorTolerance)
+  {
+    case EUNColorChangeTolerance::Quantized8Bit:
+      return Color.ToFColor(true) == CachedCollectionColor.ToFColor(true);
+    case EUNColorChangeTolerance::Exact:
+    default:
+      return Color == CachedCollectionColor;
+  }
+}
+
 void UUNImage::UpdateColorData(FUNCollectionColorData& ColorData, const FUNParameterCollectionIndex& Index, bool bIsPrimary)
 {
   if (ColorData.Index == Index)
     return;
 
-  if (ColorData.Index.Collection != Index.Collection)
-    RebindColorData(ColorData, Index.Collection.LoadSynchronous(), bIsPrimary);
+  // Subscriptions are per parameter, so the name must be set before rebinding.
+  const bool bCollectionChanged = ColorData.Index.Collection != Index.Collection;
+  ColorData.Index.ParameterName = Index.ParameterName;
+
+  if (bCollectionChanged && RequestCollectionLoad(Index.Collection))
+  {
+    WaitOnColorDataCollection(ColorData, Index.Collection, bIsPrimary);
+    return;
+  }
+
+  if (bCollectionChanged)
+    RebindColorData(ColorData, LoadCollection(Index.Collection), bIsPrimary);
+  else
+    SubscribeColorData(ColorData, GetSubscribedInstance(ColorData), bIsPrimary);
 
-  ReCacheColorDataColor(ColorData, Index.ParameterName);
+  ResolveColorDataParameter(ColorData);
 
   CalculateCachedCollectionColor();
 }
 
 void UUNImage::ForceUpdateColorData(FUNCollectionColorData& ColorData, bool bIsPrimary)
 {
-  RebindColorData(ColorData, ColorData.Index.Collection.LoadSynchronous(), bIsPrimary);
-  ReCacheColorDataColor(ColorData, ColorData.Index.ParameterName);
+  RebindColorData(ColorData, LoadCollection(ColorData.Index.Collection), bIsPrimary);
+  ResolveColorDataParameter(ColorData, ColorData.Index.ParameterName);
 }
 
 void UUNImage::RebindColorData(FUNCollectionColorData& ColorData, const UMaterialParameterCollection* Collection, bool bIsPrimary)
 {
-  if (ColorData.Index.Collection && ColorData.CollectionDelegateHandle.IsValid())
-  {
-    UMaterialParameterCollectionInstance* OldInstance = GetCollectionInstance(ColorData.Index.Collection.LoadSynchronous());
-    if (OldInstance)
-      OldInstance->OnVectorParameterUpdated().Remove(ColorData.CollectionDelegateHandle);
-  }
+  UN_SCOPE_CYCLE_COUNTER(STAT_UNiq_RebindColorData);
 
-  ColorData.CollectionDelegateHandle.Reset();
   ColorData.Index.Collection = Collection;
-  
-  UMaterialParameterCollectionInstance* NewInstance = GetCollectionInstance(Collection);
-  if (NewInstance)
-  {
-    ColorData.CollectionDelegateHandle = NewInstance->OnVectorParameterUpdated().AddUObject(this, &ThisClass::OnVectorParameterUpdated, bIsPrimary);
-  }
+  SubscribeColorData(ColorData, GetCollectionInstance(Collection), bIsPrimary);
+}
+
+void UUNImage::SubscribeColorData(FUNCollectionColorData& ColorData, UMaterialParameterCollectionInstance* Instance, bool bIsPrimary)
+{
+  SubscribeColorDataToSlot(ColorData, Instance, bIsPrimary ? PrimarySlot : SecondarySlot);
+}
+
+void UUNImage::SubscribeColorDataToSlot(FUNCollectionColorData& ColorData, UMaterialParameterCollectionInstance* Instance, int32 Slot)
+{
+  if (!Instance && ColorData.ParameterHandle == INDEX_NONE)
+    return;
+
+  UUNCollectionSubsystem* Subsystem = CollectionSubsystem.Get();
+  if (Subsystem && Subsystem->GetParameterTable().Matches(ColorData.ParameterHandle, TObjectKey<UMaterialParameterCollectionInstance>(Instance), ColorData.Index.ParameterName))
+    return;
+
+  if (Subsystem && ColorData.ParameterHandle != INDEX_NONE)
+    Subsystem->UnsubscribeVector(ColorData.ParameterHandle, this, Slot);
+
+  ColorData.ParameterHandle = INDEX_NONE;
+
+  if (!Instance || ColorData.Index.ParameterName == NAME_None)
+    return;
+
+  Subsystem = GetCollectionSubsystem();
+  if (!Subsystem)
+    return;
+
+  ColorData.ParameterHandle = Subsystem->SubscribeVector(Instance, ColorData.Index.ParameterName, this, this, Slot);
 }
 
-void UUNImage::ReCacheColorDataColor(FUNCollectionColorData& ColorData) const
+void UUNImage::ResolveColorDataParameter(FUNCollectionColorData& ColorData) const
 {
-  const UMaterialParameterCollectionInstance* CollectionInstance = GetCollectionInstance(ColorData.Index.Collection.LoadSynchronous());
+  UN_SCOPE_CYCLE_COUNTER(STAT_UNiq_ResolveColorDataParameter);
 
-  if (!CollectionInstance || !CollectionInstance->GetVectorParameterValue(ColorData.Index.ParameterName, ColorData.CachedColor))
-    ColorData.CachedColor = ColorData.Index.Collection ? ColorData.Index.Collection->GetVectorParameterByName(ColorData.Index.ParameterName)->DefaultValue : FLinearColor::White;
+  // The color itself is in the parameter table, read once per parameter no matter how many images share it.
+  const UMaterialParameterCollection* Collection = LoadCollection(ColorData.Index.Collection);
+  if (Collection && ColorData.Index.ParameterName != NAME_None && !ColorData.Index.ResolveVectorParameter(Collection))
+    UE_LOG(LogSlate, Warning, TEXT("[%s] [%s] Parameter not found in collection! Collection: [%s] Parameter: [%s]"), *FString(__FUNCTION__), *GetNameSafe(this), *GetNameSafe(Collection), *ColorData.Index.ParameterName.ToString());
 }
 
-void UUNImage::ReCacheColorDataColor(FUNCollectionColorData& ColorData, const FName& ParameterName) const
+void UUNImage::ResolveColorDataParameter(FUNCollectionColorData& ColorData, const FName& ParameterName) const
 {
   ColorData.Index.ParameterName = ParameterName;
-  ReCacheColorDataColor(ColorData);
+  ResolveColorDataParameter(ColorData);
+}
+
+FLinearColor UUNImage::GetColorDataColor(const FUNCollectionColorData& ColorData) const
+{
+  const UUNCollectionSubsystem* Subsystem = CollectionSubsystem.Get();
+  if (Subsystem && Subsystem->GetParameterTable().IsValidHandle(ColorData.ParameterHandle))
+    return Subsystem->GetParameterTable().GetValue(ColorData.ParameterHandle);
+
+  // Without a subscription there is no instance to read, such as before the world is initialized.
+  const FCollectionVectorParameter* Parameter = ColorData.Index.ResolveVectorParameter(ColorData.Index.Collection.Get());
+  return Parameter ? Parameter->DefaultValue : FLinearColor::White;
+}
+
+UMaterialParameterCollectionInstance* UUNImage::GetSubscribedInstance(const FUNCollectionColorData& ColorData) const
+{
+  const UUNCollectionSubsystem* Subsystem = CollectionSubsystem.Get();
+  if (!Subsystem || !Subsystem->GetParameterTable().IsValidHandle(ColorData.ParameterHandle))
+    return nullptr;
+
+  return Subsystem->GetParameterTable().GetInstanceKey(ColorData.ParameterHandle).ResolveObjectPtr();
 }
 
 void UUNImage::InitializeColorData()
 {
+  // Display the placeholder until every collection is loaded, then switch over all at once.
+  bWaitingOnCollections = RequestColorDataCollectionLoads();
+  if (bWaitingOnCollections)
+  {
+    bColorDataInitialized = false;
+    CalculateCachedCollectionColor();
+    return;
+  }
+
   ForceUpdateColorData(PrimaryCollectionColor, true);
   ForceUpdateColorData(SecondaryCollectionColor, false);
+  UpdateGradientColorData();
+  ForceUpdateScalarData(OpacityCollectionScalar, OpacityScalarSlot);
+  ForceUpdateScalarData(LerpAlphaCollectionScalar, LerpAlphaScalarSlot);
+  ApplyCollectionScalars();
   CalculateCachedCollectionColor();
+
+  bColorDataInitialized = true;
 }
 
-void UUNImage::OnWorldInitialized(UWorld* World, const UWorld::InitializationValues InitializationValues)
+bool UUNImage::CanReuseColorData() const
 {
-  FWorldDelegates::OnPostWorldInitialization.RemoveAll(this);
+  if (!bColorDataInitialized || bWaitingOnCollections)
+    return false;
 
-  InitializeColorData();
+#if WITH_EDITORONLY_DATA
+  // The designer edits indices in place, so always start over there.
+  if (IsDesignTime())
+    return false;
+#endif
+
+  // Bindings don't survive their subsystem, such as when the image moves to another world.
+  const UUNCollectionSubsystem* Subsystem = CollectionSubsystem.Get();
+  if (!Subsystem || Subsystem->GetWorld() != GetWorld())
+    return false;
+
+  if (!IsColorDataBindingCurrent(PrimaryCollectionColor) || !IsColorDataBindingCurrent(SecondaryCollectionColor))
+    return false;
+
+  if (!IsScalarDataBindingCurrent(OpacityCollectionScalar) || !IsScalarDataBindingCurrent(LerpAlphaCollectionScalar))
+    return false;
+
+  if (GradientColorData.Num() != CollectionGradient.Num())
+    return false;
+
+  for (const FUNCollectionColorData& ColorData : GradientColorData)
+  {
+    if (!IsColorDataBindingCurrent(ColorData))
+      return false;
+  }
+
+  return true;
+}
+
+bool UUNImage::IsColorDataBindingCurrent(const FUNCollectionColorData& ColorData) const
+{
+  if (ColorData.Index.Collection.IsNull() || ColorData.Index.ParameterName == NAME_None)
+    return true;
+
+  const UMaterialParameterCollectionInstance* Instance = GetSubscribedInstance(ColorData);
+  return Instance && CollectionSubsystem->GetParameterTable().GetParameterName(ColorData.ParameterHandle) == ColorData.Index.ParameterName
+    && Instance->GetCollection() == ColorData.Index.Collection.Get();
+}
+
+void UUNImage::UpdateScalarData(FUNCollectionScalarData& ScalarData, const FUNParameterCollectionIndex& Index, int32 Slot)
+{
+  if (ScalarData.Index == Index)
+    return;
+
+  ScalarData.Index = Index;
+
+  // Initializing again once the load finishes picks up the new scalar.
+  if (RequestCollectionLoad(Index.Collection))
+  {
+    SubscribeScalarData(ScalarData, nullptr, Slot);
+
+    if (!bWaitingOnCollections)
+    {
+      bWaitingOnCollections = true;
+      CalculateCachedCollectionColor();
+    }
+
+    return;
+  }
+
+  ForceUpdateScalarData(ScalarData, Slot);
+  ApplyCollectionScalars();
+  CalculateCachedCollectionColor();
+}
+
+void UUNImage::ForceUpdateScalarData(FUNCollectionScalarData& ScalarData, int32 Slot)
+{
+  SubscribeScalarData(ScalarData, GetCollectionInstance(LoadCollection(ScalarData.Index.Collection)), Slot);
+  ReCacheScalarDataValue(ScalarData);
 }
 
-void UUNImage::OnPrimaryParameterUpdated(TPair<FName, FLinearColor> ParameterUpdate)
+void UUNImage::SubscribeScalarData(FUNCollectionScalarData& ScalarData, UMaterialParameterCollectionInstance* Instance, int32 Slot)
 {
-  if (ParameterUpdate.Key == PrimaryCollectionColor.Index.ParameterName)
+  if (ScalarData.SubscribedInstance == Instance && ScalarData.SubscribedName == ScalarData.Index.ParameterName)
+    return;
+
+  UUNCollectionSubsystem* Subsystem = CollectionSubsystem.Get();
+  if (Subsystem && ScalarData.SubscribedInstance.IsValid())
+    Subsystem->UnsubscribeScalar(ScalarData.SubscribedInstance.Get(), ScalarData.SubscribedName, this, Slot);
+
+  ScalarData.SubscribedInstance.Reset();
+  ScalarData.SubscribedName = NAME_None;
+
+  if (!Instance || ScalarData.Index.ParameterName == NAME_None)
+    return;
+
+  Subsystem = GetCollectionSubsystem();
+  if (!Subsystem)
+    return;
+
+  Subsystem->SubscribeScalar(Instance, ScalarData.Index.ParameterName, this, this, Slot);
+  ScalarData.SubscribedInstance = Instance;
+  ScalarData.SubscribedName = ScalarData.Index.ParameterName;
+}
+
+void UUNImage::ReCacheScalarDataValue(FUNCollectionScalarData& ScalarData) const
+{
+  const UMaterialParameterCollection* Collection = LoadCollection(ScalarData.Index.Collection);
+  const FCollectionScalarParameter* Parameter = ScalarData.Index.ResolveScalarParameter(Collection);
+
+  // Without a parameter, whatever the scalar drives is left alone rather than zeroed.
+  if (!Parameter)
   {
-    PrimaryCollectionColor.CachedColor = ParameterUpdate.Value;
-    CalculateCachedCollectionColor();
+    if (Collection && ScalarData.Index.ParameterName != NAME_None)
+      UE_LOG(LogSlate, Warning, TEXT("[%s] [%s] Scalar parameter not found in collection! Collection: [%s] Parameter: [%s]"), *FString(__FUNCTION__), *GetNameSafe(this), *GetNameSafe(Collection), *ScalarData.Index.ParameterName.ToString());
+
+    ScalarData.bHasCachedValue = false;
+    return;
+  }
+
+  const UMaterialParameterCollectionInstance* CollectionInstance = GetCollectionInstance(Collection);
+
+  if (!CollectionInstance || !CollectionInstance->GetScalarParameterValue(*Parameter, ScalarData.CachedValue))
+    ScalarData.CachedValue = Parameter->DefaultValue;
+
+  ScalarData.bHasCachedValue = true;
+}
+
+bool UUNImage::IsScalarDataBindingCurrent(const FUNCollectionScalarData& ScalarData) const
+{
+  if (ScalarData.Index.Collection.IsNull() || ScalarData.Index.ParameterName == NAME_None)
+    return true;
+
+  const UMaterialParameterCollectionInstance* Instance = ScalarData.SubscribedInstance.Get();
+  return Instance && ScalarData.SubscribedName == ScalarData.Index.ParameterName && Instance->GetCollection() == ScalarData.Index.Collection.Get();
+}
+
+void UUNImage::ApplyCollectionScalars()
+{
+  // Setting the same opacity still invalidates the widget, so only push actual changes.
+  if (OpacityCollectionScalar.bHasCachedValue && GetRenderOpacity() != OpacityCollectionScalar.CachedValue)
+    SetRenderOpacity(OpacityCollectionScalar.CachedValue);
+
+  if (LerpAlphaCollectionScalar.bHasCachedValue)
+    CollectionLerpAlpha = LerpAlphaCollectionScalar.CachedValue;
+}
+
+void UUNImage::UpdateGradientColorData()
+{
+  // Stops are kept sorted, so the lookup table can be built in a single walk.
+  TArray<FUNCollectionGradientStop> SortedStops = CollectionGradient;
+  SortedStops.StableSort([](const FUNCollectionGradientStop& A, const FUNCollectionGradientStop& B) { return A.Position < B.Position; });
+
+  // Unsubscribe any stops that no longer exist. The rest resubscribe below, but only if their parameter changed.
+  for (int32 i = SortedStops.Num(); i < GradientColorData.Num(); ++i)
+  {
+    SubscribeColorDataToSlot(GradientColorData[i], nullptr, GradientSlotOffset + i);
+  }
+
+  GradientColorData.SetNum(SortedStops.Num());
+  GradientPositions.SetNum(SortedStops.Num());
+
+  for (int32 i = 0; i < SortedStops.Num(); ++i)
+  {
+    FUNCollectionColorData& ColorData = GradientColorData[i];
+    ColorData.Index = SortedStops[i].Index;
+    GradientPositions[i] = FMath::Clamp(SortedStops[i].Position, 0.0f, 1.0f);
+
+    SubscribeColorDataToSlot(ColorData, GetCollectionInstance(LoadCollection(ColorData.Index.Collection)), GradientSlotOffset + i);
+    ResolveColorDataParameter(ColorData);
+  }
+
+  bGradientLUTDirty = true;
+}
+
+void UUNImage::RebuildGradientLUT() const
+{
+  bGradientLUTDirty = false;
+
+  const int32 NumSamples = FMath::Clamp(GradientLUTResolution, 2, 1024);
+  GradientLUT.SetNumUninitialized(NumSamples);
+
+  const int32 NumStops = GradientColorData.Num();
+  if (NumStops == 0)
+  {
+    for (FLinearColor& Sample : GradientLUT)
+    {
+      Sample = FLinearColor::White;
+    }
+
+    return;
+  }
+
+  // Every stop is read many times below, so only look each one up once.
+  TArray<FLinearColor, TInlineAllocator<8>> StopColors;
+  StopColors.Reserve(NumStops);
+
+  for (const FUNCollectionColorData& ColorData : GradientColorData)
+  {
+    StopColors.Add(GetColorDataColor(ColorData));
+  }
+
+  // Samples and stops are both sorted, so the stop after each sample only ever moves forward.
+  int32 UpperStop = 0;
+
+  for (int32 i = 0; i < NumSamples; ++i)
+  {
+    const float Alpha = static_cast<float>(i) / static_cast<float>(NumSamples - 1);
+
+    while (UpperStop < NumStops && GradientPositions[UpperStop] < Alpha)
+    {
+      ++UpperStop;
+    }
+
+    if (UpperStop == 0)
+    {
+      GradientLUT[i] = StopColors[0];
+    }
+    else if (UpperStop == NumStops)
+    {
+      GradientLUT[i] = StopColors[NumStops - 1];
+    }
+    else
+    {
+      const int32 LowerStop = UpperStop - 1;
+      const float Span = GradientPositions[UpperStop] - GradientPositions[LowerStop];
+      const float StopAlpha = Span > UE_SMALL_NUMBER ? (Alpha - GradientPositions[LowerStop]) / Span : 1.0f;
+      GradientLUT[i] = FMath::Lerp(StopColors[LowerStop], StopColors[UpperStop], StopAlpha);
+    }
   }
 }
 
-void UUNImage::OnSecondaryParameterUpdated(TPair<FName, FLinearColor> ParameterUpdate)
+const UMaterialParameterCollection* UUNImage::LoadCollection(const TSoftObjectPtr<UMaterialParameterCollection>& Collection) const
+{
+  if (bLoadCollectionsAsync)
+    return Collection.Get();
+
+  // Only count the loads that actually have to hit the disk.
+  if (!Collection.IsNull() && !Collection.IsValid())
+    INC_DWORD_STAT(STAT_UNiq_SynchronousLoads);
+
+  return Collection.LoadSynchronous();
+}
+
+bool UUNImage::RequestCollectionLoad(const TSoftObjectPtr<UMaterialParameterCollection>& Collection)
+{
+  if (!bLoadCollectionsAsync || Collection.IsNull() || Collection.IsValid())
+    return false;
+
+  UUNCollectionSubsystem* Subsystem = GetCollectionSubsystem();
+  if (!Subsystem)
+    return false;
+
+  return Subsystem->RequestCollectionLoad(Collection, this, this);
+}
+
+bool UUNImage::RequestColorDataCollectionLoads()
 {
-  if (ParameterUpdate.Key == SecondaryCollectionColor.Index.ParameterName)
+  // Request both, so that the loads run in parallel.
+  const bool bPrimaryLoading = RequestCollectionLoad(PrimaryCollectionColor.Index.Collection);
+  const bool bSecondaryLoading = RequestCollectionLoad(SecondaryCollectionColor.Index.Collection);
+
+  bool bGradientLoading = false;
+  for (const FUNCollectionGradientStop& Stop : CollectionGradient)
+  {
+    bGradientLoading |= RequestCollectionLoad(Stop.Index.Collection);
+  }
+
+  const bool bOpacityLoading = RequestCollectionLoad(OpacityCollectionScalar.Index.Collection);
+  const bool bLerpAlphaLoading = RequestCollectionLoad(LerpAlphaCollectionScalar.Index.Collection);
+
+  return bPrimaryLoading || bSecondaryLoading || bGradientLoading || bOpacityLoading || bLerpAlphaLoading;
+}
+
+void UUNImage::WaitOnColorDataCollection(FUNCollectionColorData& ColorData, const TSoftObjectPtr<UMaterialParameterCollection>& Collection, bool bIsPrimary)
+{
+  SubscribeColorData(ColorData, nullptr, bIsPrimary);
+  ColorData.Index.Collection = Collection;
+
+  if (!bWaitingOnCollections)
   {
-    SecondaryCollectionColor.CachedColor = ParameterUpdate.Value;
+    bWaitingOnCollections = true;
     CalculateCachedCollectionColor();
   }
 }
 
-void UUNImage::OnVectorParameterUpdated(TPair<FName, FLinearColor> ParameterUpdate, bool bIsPrimary)
+FLinearColor UUNImage::ResolveCollectionColorOnPaint()
+{
+  // Honor the tolerance like CalculateCachedCollectionColor. Within it, the slate widget gets the old color back and sees no change.
+  const FLinearColor NewColor = ComputeCollectionColor();
+  if (!IsCollectionColorUnchanged(NewColor))
+    CachedCollectionColor = NewColor;
+
+  return CachedCollectionColor;
+}
+
+void UUNImage::OnCollectionWorldInitialized(UWorld* World)
+{
+  bWaitingOnWorldInitialization = false;
+  InitializeColorData();
+}
+
+void UUNImage::OnCollectionWorldCleanedUp(UWorld* World)
+{
+  // Nothing is initialized. Rebuilding in another world queues this image again.
+  bWaitingOnWorldInitialization = false;
+}
+
+void UUNImage::OnCollectionColorEvaluated(const FLinearColor& Color)
+{
+  // The pool only reports exact changes, so the tolerance still needs to be checked.
+  if (IsCollectionColorUnchanged(Color))
+    return;
+
+  CachedCollectionColor = Color;
+
+  if (MyUNImage.IsValid())
+    MyUNImage->SetCollectionColor(CachedCollectionColor);
+}
+
+void UUNImage::OnCollectionSubscriptionsReleased()
+{
+  // The handles belonged to the old subsystem's table. Everything is bound again on the next initialization.
+  PrimaryCollectionColor.ParameterHandle = INDEX_NONE;
+  SecondaryCollectionColor.ParameterHandle = INDEX_NONE;
+
+  for (FUNCollectionColorData& ColorData : GradientColorData)
+  {
+    ColorData.ParameterHandle = INDEX_NONE;
+  }
+
+  for (FUNCollectionScalarData* ScalarData : { &OpacityCollectionScalar, &LerpAlphaCollectionScalar })
+  {
+    ScalarData->SubscribedInstance.Reset();
+    ScalarData->SubscribedName = NAME_None;
+  }
+
+  bColorDataInitialized = false;
+}
+
+void UUNImage::OnCollectionVectorUpdated(int32 Slot, const FLinearColor& Value)
 {
-  if (bIsPrimary)
-    OnPrimaryParameterUpdated(ParameterUpdate);
+  // The value is already in the parameter table, so only the gradient's lookup table needs to know.
+  if (Slot >= GradientSlotOffset)
+    bGradientLUTDirty = true;
+}
+
+void UUNImage::OnCollectionScalarUpdated(int32 Slot, float Value)
+{
+  FUNCollectionScalarData& ScalarData = Slot == OpacityScalarSlot ? OpacityCollectionScalar : LerpAlphaCollectionScalar;
+  ScalarData.CachedValue = Value;
+  ScalarData.bHasCachedValue = true;
+}
+
+void UUNImage::OnCollectionUpdatesApplied()
+{
+  // Called once per batch of updates, even if both colors and both scalars changed.
+  ApplyCollectionScalars();
+  CalculateCachedCollectionColor();
+}
+
+void UUNImage::OnCollectionLoaded(const UMaterialParameterCollection* Collection)
+{
+  if (!bWaitingOnCollections)
+    return;
+
+  // Initializing re-requests anything still loading, so this only switches over once everything is in. A failed
+  // collection is not requested again, so its colors fall back to white instead of waiting forever.
+  InitializeColorData();
+}
+
+UUNCollectionSubsystem* UUNImage::GetCollectionSubsystem() const
+{
+  if (!CollectionSubsystem.IsValid())
+    CollectionSubsystem = UUNCollectionSubsystem::Get(GetWorld());
+
+  return CollectionSubsystem.Get();
+}
+
+void UUNImage::UpdateColorPoolEntry(const FLinearColor& Color)
+{
+  // Without a subsystem there are no subscriptions, so there is nothing for the pool to evaluate.
+  UUNCollectionSubsystem* Subsystem = CollectionSubsystem.Get();
+  if (!Subsystem)
+    return;
+
+  // The pool only lerps between the real primary and secondary colors, so placeholders, gradients, and lazy
+  // resolves stay out of it.
+  if (MyUNImage.IsValid() && !bWaitingOnCollections && !ShouldResolveCollectionColorOnPaint() && !UsesCollectionGradient())
+  {
+    Subsystem->UpdateColorPoolEntry(this, this, PrimaryCollectionColor.ParameterHandle, SecondaryCollectionColor.ParameterHandle,
+      GetColorDataColor(PrimaryCollectionColor), GetColorDataColor(SecondaryCollectionColor), CollectionLerpAlpha, Color);
+  }
   else
-    OnSecondaryParameterUpdated(ParameterUpdate);
+  {
+    Subsystem->RemoveFromColorPool(this);
+  }
+}
+
+void UUNImage::RemoveFromColorPool()
+{
+  if (UUNCollectionSubsystem* Subsystem = CollectionSubsystem.Get())
+    Subsystem->RemoveFromColorPool(this);
 }
 
 UMaterialParameterCollectionInstance* UUNImage::GetCollectionInstance(const UMaterialParameterCollection* Collection) const
@@ -224,6 +873,14 @@ UMaterialParameterCollectionInstance* UUNImage::GetCollectionInstance(const UMat
   {
     return nullptr;
   }
+
+  // Most lookups hit the subsystem's cache, skipping the world checks and linear search below.
+  UUNCollectionSubsystem* Subsystem = GetCollectionSubsystem();
+  if (Subsystem)
+  {
+    if (UMaterialParameterCollectionInstance* CachedInstance = Subsystem->FindCachedCollectionInstance(Collection))
+      return CachedInstance;
+  }
   
   UWorld* World = GetWorld();
   if (!World)
@@ -249,7 +906,7 @@ UMaterialParameterCollectionInstance* UUNImage::GetCollectionInstance(const UMat
   }
   
   // Get the collection instance.
-  UMaterialParameterCollectionInstance* Instance = World->GetParameterCollectionInstance(Collection);
+  UMaterialParameterCollectionInstance* Instance = Subsystem ? Subsystem->GetCollectionInstance(Collection) : World->GetParameterCollectionInstance(Collection);
   if (!Instance)
   {
     UE_LOG(LogSlate, Warning, TEXT("[%s] [%s] Unable to get instance parameter collection! Collection: [%s]"), *FString(__FUNCTION__), *GetNameSafe(this), *GetNameSafe(Collection));
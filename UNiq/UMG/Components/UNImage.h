@@ -4,11 +4,27 @@
 
 #include "Components/Image.h"
 #include "Materials/MaterialParameterCollection.h"
+#include "UNCollectionSubsystem.h"
+#include "UNTweenSubsystem.h"
 
 #include "UNImage.generated.h"
 
 class SUNImage;
 
+/**
+ * @enum EUNColorChangeTolerance
+ * @brief How different a newly resolved collection color must be from the displayed one to be pushed to Slate.
+ */
+UENUM(BlueprintType)
+enum class EUNColorChangeTolerance : uint8
+{
+  // Any difference in the color is pushed.
+  Exact,
+
+  // Only differences that survive 8-bit sRGB quantization are pushed.
+  Quantized8Bit UMETA(DisplayName = "Quantized (8-bit)")
+};
+
 /**
  * @struct FUNParameterCollectionIndex
  * @brief A struct containing parameter data into a parameter collection.
@@ -20,13 +36,64 @@ struct FUNParameterCollectionIndex
 
   FUNParameterCollectionIndex()
     : Collection(nullptr)
+    , CachedParameterIndex(INDEX_NONE)
   {
   }
 
   FUNParameterCollectionIndex(const TObjectPtr<UMaterialParameterCollection> InCollection, const FName& InName)
     : Collection(InCollection)
     , ParameterName(InName)
+    , CachedParameterIndex(INDEX_NONE)
+  {
+  }
+
+  /**
+   * Resolves the vector parameter in a loaded Collection. The parameter's index is cached, so later
+   * resolves are an indexed read and a name check instead of a search.
+   * @param InCollection The loaded Collection.
+   * @returns Returns the vector parameter, or null if the Collection has no parameter of the ParameterName.
+   */
+  const FCollectionVectorParameter* ResolveVectorParameter(const UMaterialParameterCollection* InCollection) const
+  {
+    if (!InCollection)
+      return nullptr;
+
+    const TArray<FCollectionVectorParameter>& Parameters = InCollection->VectorParameters;
+
+    // The name check keeps the cache valid if the collection is edited.
+    if (!Parameters.IsValidIndex(CachedParameterIndex) || Parameters[CachedParameterIndex].ParameterName != ParameterName)
+    {
+      CachedParameterIndex = Parameters.IndexOfByPredicate([this](const FCollectionVectorParameter& Parameter)
+      {
+        return Parameter.ParameterName == ParameterName;
+      });
+    }
+
+    return CachedParameterIndex != INDEX_NONE ? &Parameters[CachedParameterIndex] : nullptr;
+  }
+
+  /**
+   * Resolves the scalar parameter in a loaded Collection, caching its index the same as ResolveVectorParameter.
+   * An index should only ever be resolved as one kind of parameter.
+   * @param InCollection The loaded Collection.
+   * @returns Returns the scalar parameter, or null if the Collection has no parameter of the ParameterName.
+   */
+  const FCollectionScalarParameter* ResolveScalarParameter(const UMaterialParameterCollection* InCollection) const
   {
+    if (!InCollection)
+      return nullptr;
+
+    const TArray<FCollectionScalarParameter>& Parameters = InCollection->ScalarParameters;
+
+    if (!Parameters.IsValidIndex(CachedParameterIndex) || Parameters[CachedParameterIndex].ParameterName != ParameterName)
+    {
+      CachedParameterIndex = Parameters.IndexOfByPredicate([this](const FCollectionScalarParameter& Parameter)
+      {
+        return Parameter.ParameterName == ParameterName;
+      });
+    }
+
+    return CachedParameterIndex != INDEX_NONE ? &Parameters[CachedParameterIndex] : nullptr;
   }
 
   // The parameter collection to get the color from.
@@ -37,6 +104,9 @@ struct FUNParameterCollectionIndex
   UPROPERTY(EditAnywhere, BlueprintReadWrite)
   FName ParameterName;
 
+  // The cached index of the parameter in the Collection's parameters. Resolved at bind time.
+  mutable int32 CachedParameterIndex;
+
   FORCEINLINE bool operator==(const FUNParameterCollectionIndex& Other) const
   {
     return this->ParameterName == Other.ParameterName && this->Collection == Other.Collection; 
@@ -58,6 +128,7 @@ struct FUNCollectionColorData
   GENERATED_BODY()
 
   FUNCollectionColorData()
+    : ParameterHandle(INDEX_NONE)
   {
   }
 
@@ -65,23 +136,93 @@ struct FUNCollectionColorData
   UPROPERTY(EditAnywhere, meta = (ShowOnlyInnerProperties))
   FUNParameterCollectionIndex Index;
 
-  // The cached color obtained from the parameter collection.
-  FLinearColor CachedColor;
+  // The handle of the subscribed parameter in the collection subsystem's parameter table, which holds its color
+  // for every image bound to it. INDEX_NONE while unsubscribed.
+  int32 ParameterHandle;
+};
+
+/**
+ * @struct FUNCollectionScalarData
+ * @brief A struct containing data about a scalar obtained from a parameter collection.
+ */
+USTRUCT()
+struct FUNCollectionScalarData
+{
+  GENERATED_BODY()
+
+  FUNCollectionScalarData()
+    : CachedValue(0.0f)
+    , bHasCachedValue(false)
+  {
+  }
+
+  // The parameter collection and scalar parameter name associated with this value. Unbound if either is unset.
+  UPROPERTY(EditAnywhere, meta = (ShowOnlyInnerProperties))
+  FUNParameterCollectionIndex Index;
+
+  // The cached value obtained from the parameter collection.
+  float CachedValue;
+
+  // If true, the CachedValue was resolved from the parameter collection, and is applied.
+  bool bHasCachedValue;
+
+  // The collection instance this scalar data is currently subscribed to.
+  TWeakObjectPtr<UMaterialParameterCollectionInstance> SubscribedInstance;
 
-  // A handle to the delegate for this color data.
-  FDelegateHandle CollectionDelegateHandle;
+  // The parameter name this scalar data is currently subscribed to.
+  FName SubscribedName;
+};
+
+/**
+ * @struct FUNCollectionGradientStop
+ * @brief A single color stop in a collection color gradient.
+ */
+USTRUCT(BlueprintType)
+struct FUNCollectionGradientStop
+{
+  GENERATED_BODY()
+
+  FUNCollectionGradientStop()
+    : Position(0.0f)
+  {
+  }
+
+  FUNCollectionGradientStop(const FUNParameterCollectionIndex& InIndex, float InPosition)
+    : Index(InIndex)
+    , Position(InPosition)
+  {
+  }
+
+  // The parameter collection and parameter name of the stop's color.
+  UPROPERTY(EditAnywhere, BlueprintReadWrite)
+  FUNParameterCollectionIndex Index;
+
+  // The lerp alpha the stop's color is at.
+  UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "0.0", ClampMax = "1.0"))
+  float Position;
 };
 
 /**
  * @class UUNImage
  * @brief An image widget. This widget listens to changes in a MaterialParameterCollection. It contains
  * two colors, a primary and secondary color. These two can be lerped between for animation purposes.
+ * Its render opacity and lerp alpha can also be bound to scalar parameters, pushed only when they change.
+ * Releasing the slate resources keeps the collection bindings alive, so images in pooled entry widgets
+ * skip rebinding and re-caching entirely when they are rebuilt with the same collection indices.
  */
 UCLASS(BlueprintType, Blueprintable)
-class UNIQ_API UUNImage : public UImage
+class UNIQ_API UUNImage : public UImage, public FUNCollectionListener
 {
   GENERATED_UCLASS_BODY()
 
+public:
+  // Begin UObject Interface
+  virtual void BeginDestroy() override;
+#if WITH_EDITOR
+  virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+  // End UObject Interface
+
 protected:
   // Begin UWidget Interface
   virtual TSharedRef<SWidget> RebuildWidget() override;
@@ -89,6 +230,17 @@ protected:
   virtual void ReleaseSlateResources(bool bReleaseChildren) override;
   // End UWidget Interface
 
+  // Begin FUNCollectionListener Interface
+  virtual void OnCollectionVectorUpdated(int32 Slot, const FLinearColor& Value) override;
+  virtual void OnCollectionScalarUpdated(int32 Slot, float Value) override;
+  virtual void OnCollectionUpdatesApplied() override;
+  virtual void OnCollectionLoaded(const UMaterialParameterCollection* Collection) override;
+  virtual void OnCollectionWorldInitialized(UWorld* World) override;
+  virtual void OnCollectionWorldCleanedUp(UWorld* World) override;
+  virtual void OnCollectionColorEvaluated(const FLinearColor& Color) override;
+  virtual void OnCollectionSubscriptionsReleased() override;
+  // End FUNCollectionListener Interface
+
 public:
   /**
    * Sets the index of a collection color.
@@ -123,7 +275,8 @@ public:
   void SetCollectionColorName(const FName& ParameterName, bool bIsPrimary);
 
   /**
-   * Sets the linear interpolation between the primary and secondary collection colors.
+   * Sets the linear interpolation between the primary and secondary collection colors. Ignored while the
+   * LerpAlphaCollectionScalar is bound.
    * @param Alpha The linear interpolation alpha to use.
    */
   UFUNCTION(BlueprintCallable, Category = "Collection Color")
@@ -136,6 +289,92 @@ public:
   UFUNCTION(BlueprintPure, Category = "Collection Color")
   float GetCollectionLerpAlpha() const { return CollectionLerpAlpha; }
 
+  /**
+   * Natively tweens the linear interpolation between the primary and secondary collection colors, without
+   * a widget animation or Blueprint tick. Replaces any tween already running on this image. While the
+   * LerpAlphaCollectionScalar is bound, this only stops the running tween.
+   * @param TargetAlpha The linear interpolation alpha to end at.
+   * @param Duration The length of the tween, in seconds. If not positive, the alpha is set immediately.
+   * @param Easing The easing curve to apply.
+   * @param EasingExponent The exponent of the easing curve. Unused for linear tweens.
+   */
+  UFUNCTION(BlueprintCallable, BlueprintCosmetic, Category = "Collection Color")
+  void TweenCollectionLerpAlpha(float TargetAlpha, float Duration, EUNTweenEasing Easing = EUNTweenEasing::Linear, float EasingExponent = 2.0f);
+
+  /** Stops any tween of the CollectionLerpAlpha, leaving it where it currently is.*/
+  UFUNCTION(BlueprintCallable, BlueprintCosmetic, Category = "Collection Color")
+  void StopCollectionLerpAlphaTween();
+
+  /**
+   * Sets the collection color gradient. While it has any stops, the CollectionLerpAlpha samples the gradient
+   * instead of lerping between the primary and secondary collection colors.
+   * @param Stops The stops of the gradient, in any order.
+   */
+  UFUNCTION(BlueprintCallable, BlueprintCosmetic, Category = "Collection Color")
+  void SetCollectionGradient(const TArray<FUNCollectionGradientStop>& Stops);
+
+  /** Removes every stop of the collection color gradient, going back to the primary and secondary collection colors.*/
+  UFUNCTION(BlueprintCallable, BlueprintCosmetic, Category = "Collection Color")
+  void ClearCollectionGradient();
+
+  /**
+   * Gets the stops of the collection color gradient.
+   * @returns Returns the CollectionGradient.
+   */
+  UFUNCTION(BlueprintPure, Category = "Collection Color")
+  const TArray<FUNCollectionGradientStop>& GetCollectionGradient() const { return CollectionGradient; }
+
+  /**
+   * Sets the number of samples in the gradient lookup table. The table is rebuilt on its next sample.
+   * @param Resolution The number of samples. Clamped between 2 and 1024.
+   */
+  UFUNCTION(BlueprintCallable, BlueprintCosmetic, Category = "Collection Color")
+  void SetGradientLUTResolution(int32 Resolution);
+
+  /**
+   * Gets the number of samples in the gradient lookup table.
+   * @returns Returns the GradientLUTResolution.
+   */
+  UFUNCTION(BlueprintPure, Category = "Collection Color")
+  int32 GetGradientLUTResolution() const { return GradientLUTResolution; }
+
+  /**
+   * Binds the render opacity to a scalar parameter in a collection. The opacity is then pushed whenever the
+   * parameter changes, instead of being polled. Pass an empty index to unbind, keeping the current opacity.
+   * @param Index The collection and scalar parameter name to use.
+   */
+  UFUNCTION(BlueprintCallable, BlueprintCosmetic, Category = "Collection Scalar")
+  void SetOpacityCollectionScalar(const FUNParameterCollectionIndex& Index);
+
+  /**
+   * Binds the CollectionLerpAlpha to a scalar parameter in a collection. While bound, the parameter overrides
+   * any alpha that is set or tweened directly. Pass an empty index to unbind, keeping the current alpha.
+   * @param Index The collection and scalar parameter name to use.
+   */
+  UFUNCTION(BlueprintCallable, BlueprintCosmetic, Category = "Collection Scalar")
+  void SetLerpAlphaCollectionScalar(const FUNParameterCollectionIndex& Index);
+
+  /**
+   * Gets the collection scalar the render opacity is bound to.
+   * @returns Returns the index of the OpacityCollectionScalar.
+   */
+  UFUNCTION(BlueprintPure, Category = "Collection Scalar")
+  const FUNParameterCollectionIndex& GetOpacityCollectionScalar() const { return OpacityCollectionScalar.Index; }
+
+  /**
+   * Gets the collection scalar the CollectionLerpAlpha is bound to.
+   * @returns Returns the index of the LerpAlphaCollectionScalar.
+   */
+  UFUNCTION(BlueprintPure, Category = "Collection Scalar")
+  const FUNParameterCollectionIndex& GetLerpAlphaCollectionScalar() const { return LerpAlphaCollectionScalar.Index; }
+
+  /**
+   * Checks if the CollectionLerpAlpha is currently driven by the LerpAlphaCollectionScalar.
+   * @returns Returns true if the bound scalar resolved, and overrides any alpha set or tweened directly.
+   */
+  UFUNCTION(BlueprintPure, Category = "Collection Scalar")
+  bool IsCollectionLerpAlphaBound() const { return LerpAlphaCollectionScalar.bHasCachedValue; }
+
 protected:
   /**
    * Sets the index of a collection color.
@@ -169,8 +408,53 @@ protected:
   UFUNCTION(BlueprintCallable, BlueprintCosmetic, Category = "Collection Color", DisplayName = "Set Collection Color Name")
   void SetCollectionColorNameBP(FName ParameterName, bool bIsPrimary);
 
+  /**
+   * Creates the slate widget for this image. Override to use a subclass of SUNImage.
+   * @returns Returns the new slate widget.
+   */
+  virtual TSharedRef<SUNImage> ConstructUNImage();
+
   /** Calculates a final CollectionColor to apply to the slate widget.*/
-  void CalculateCachedCollectionColor();
+  virtual void CalculateCachedCollectionColor();
+
+  /**
+   * Checks if the collection color should be resolved lazily when the slate widget paints.
+   * @returns Returns true if the collection color is resolved on paint.
+   */
+  virtual bool ShouldResolveCollectionColorOnPaint() const { return bResolveCollectionColorOnPaint; }
+
+  /**
+   * Computes the collection color from the current cached colors and lerp alpha.
+   * @returns Returns the collection color to display.
+   */
+  FLinearColor ComputeCollectionColor() const;
+
+  /**
+   * Gets the resolved primary and secondary collection colors. Both are the AsyncPlaceholderColor while loading.
+   * @param OutPrimary The resolved primary color.
+   * @param OutSecondary The resolved secondary color.
+   */
+  void GetResolvedCollectionColors(FLinearColor& OutPrimary, FLinearColor& OutSecondary) const;
+
+  /**
+   * Checks if the collection color is sampled from the collection color gradient.
+   * @returns Returns true if the gradient has any stops.
+   */
+  bool UsesCollectionGradient() const { return !GradientColorData.IsEmpty(); }
+
+  /**
+   * Samples the collection color gradient, rebuilding its lookup table first if a stop changed.
+   * @param Alpha The position in the gradient, from 0 to 1.
+   * @returns Returns the gradient's color at the Alpha.
+   */
+  FLinearColor SampleCollectionGradient(float Alpha) const;
+
+  /**
+   * Checks if a collection color would look the same as the CachedCollectionColor, given the CollectionColorTolerance.
+   * @param Color The color to check.
+   * @returns Returns true if the color is unchanged, and does not need to be pushed to the slate widget.
+   */
+  bool IsCollectionColorUnchanged(const FLinearColor& Color) const;
 
 private:
   /**
@@ -197,42 +481,158 @@ private:
   void RebindColorData(FUNCollectionColorData& ColorData, const UMaterialParameterCollection* Collection, bool bIsPrimary);
 
   /**
-   * Re-caches a color data container with its designated color from its index.
+   * Subscribes a color data container to its parameter in a collection instance, replacing its old subscription.
+   * @param ColorData the color data to update.
+   * @param Instance The collection instance to subscribe to. If null, the color data is only unsubscribed.
+   * @param bIsPrimary If true, this is the primary color collection. Otherwise, it is the secondary collection.
+   */
+  void SubscribeColorData(FUNCollectionColorData& ColorData, UMaterialParameterCollectionInstance* Instance, bool bIsPrimary);
+
+  /**
+   * Subscribes a color data container to its parameter in a collection instance, replacing its old subscription.
    * @param ColorData the color data to update.
+   * @param Instance The collection instance to subscribe to. If null, the color data is only unsubscribed.
+   * @param Slot The subscription slot of the color data.
    */
-  void ReCacheColorDataColor(FUNCollectionColorData& ColorData) const;
+  void SubscribeColorDataToSlot(FUNCollectionColorData& ColorData, UMaterialParameterCollectionInstance* Instance, int32 Slot);
 
   /**
-   * Re-caches a color data container with its designated color from its index.
+   * Resolves the parameter of a color data container's index, warning if its collection does not have it.
+   * @param ColorData the color data to update.
+   */
+  void ResolveColorDataParameter(FUNCollectionColorData& ColorData) const;
+
+  /**
+   * Resolves the parameter of a color data container's index, warning if its collection does not have it.
    * @param ColorData the color data to update.
    * @param ParameterName The new parameter name to use.
    */
-  void ReCacheColorDataColor(FUNCollectionColorData& ColorData, const FName& ParameterName) const;
+  void ResolveColorDataParameter(FUNCollectionColorData& ColorData, const FName& ParameterName) const;
+
+  /**
+   * Gets the current color of a color data container. Subscribed colors are read from the parameter table.
+   * @param ColorData The color data to get the color of.
+   * @returns Returns the color. This is the parameter's default while unsubscribed, or white without a parameter.
+   */
+  FLinearColor GetColorDataColor(const FUNCollectionColorData& ColorData) const;
+
+  /**
+   * Gets the collection instance a color data container is subscribed to.
+   * @param ColorData The color data to check.
+   * @returns Returns the subscribed instance, or null if unsubscribed.
+   */
+  UMaterialParameterCollectionInstance* GetSubscribedInstance(const FUNCollectionColorData& ColorData) const;
 
   /** Initializes both the primary and secondary color data with their bindings and color caches.*/
   void InitializeColorData();
 
-  /** A delegate called upon the current world being initialized, allowing to set bindings.*/
-  void OnWorldInitialized(UWorld* World, const UWorld::InitializationValues InitializationValues);
+  /**
+   * Checks if the color data bindings from a previous initialization are all still in place, and the cached
+   * colors have been kept up to date through them. This is the case for images reacquired from a widget pool.
+   * @returns Returns true if the color data can be reused as is, without initializing it again.
+   */
+  bool CanReuseColorData() const;
+
+  /**
+   * Checks if a color data container is still subscribed to exactly the parameter of its index.
+   * @param ColorData The color data to check.
+   * @returns Returns true if the subscription matches the index, or if the index has nothing to subscribe to.
+   */
+  bool IsColorDataBindingCurrent(const FUNCollectionColorData& ColorData) const;
+
+  /**
+   * Updates a scalar data container with a new index, and rebinds it.
+   * @param ScalarData The scalar data to update.
+   * @param Index The new collection and parameter name to use.
+   * @param Slot The scalar subscription slot of the scalar data.
+   */
+  void UpdateScalarData(FUNCollectionScalarData& ScalarData, const FUNParameterCollectionIndex& Index, int32 Slot);
+
+  /**
+   * Forces a scalar data container to reapply its binding and cached value.
+   * @param ScalarData The scalar data to update.
+   * @param Slot The scalar subscription slot of the scalar data.
+   */
+  void ForceUpdateScalarData(FUNCollectionScalarData& ScalarData, int32 Slot);
+
+  /**
+   * Subscribes a scalar data container to its parameter in a collection instance, replacing its old subscription.
+   * @param ScalarData The scalar data to update.
+   * @param Instance The collection instance to subscribe to. If null, the scalar data is only unsubscribed.
+   * @param Slot The scalar subscription slot of the scalar data.
+   */
+  void SubscribeScalarData(FUNCollectionScalarData& ScalarData, UMaterialParameterCollectionInstance* Instance, int32 Slot);
+
+  /**
+   * Re-caches a scalar data container with its designated value from its index.
+   * @param ScalarData The scalar data to update.
+   */
+  void ReCacheScalarDataValue(FUNCollectionScalarData& ScalarData) const;
+
+  /**
+   * Checks if a scalar data container is still subscribed to exactly the parameter of its index.
+   * @param ScalarData The scalar data to check.
+   * @returns Returns true if the subscription matches the index, or if the index has nothing to subscribe to.
+   */
+  bool IsScalarDataBindingCurrent(const FUNCollectionScalarData& ScalarData) const;
+
+  /** Applies the cached value of each bound scalar to the render opacity and CollectionLerpAlpha.*/
+  void ApplyCollectionScalars();
+
+  /** Rebuilds the color data of every gradient stop from the CollectionGradient, and rebinds them.*/
+  void UpdateGradientColorData();
+
+  /** Rebuilds the GradientLUT from the cached color of every gradient stop.*/
+  void RebuildGradientLUT() const;
+
+  /**
+   * Gets a collection for use, loading it synchronously unless bLoadCollectionsAsync is set.
+   * @param Collection The collection to get.
+   * @returns Returns the collection, if loaded.
+   */
+  const UMaterialParameterCollection* LoadCollection(const TSoftObjectPtr<UMaterialParameterCollection>& Collection) const;
+
+  /**
+   * Requests an async load of a collection if bLoadCollectionsAsync is set and it is not yet loaded.
+   * @param Collection The collection to request.
+   * @returns Returns true if the collection is still loading and must be waited on. False once its load has failed.
+   */
+  bool RequestCollectionLoad(const TSoftObjectPtr<UMaterialParameterCollection>& Collection);
+
+  /**
+   * Requests async loads of any collections of the color data that are not yet loaded.
+   * @returns Returns true if any collection is still loading and must be waited on.
+   */
+  bool RequestColorDataCollectionLoads();
 
   /**
-   * A delegate called upon a material parameter collection updating a vector value.
-   * @param ParameterUpdate the parameter in the collection that was updated.
-   * @param bIsPrimary If true, this parameter is for the primary data. Otherwise, it is for the secondary data.
+   * Sets a color data container to wait on its collection's async load, displaying the AsyncPlaceholderColor until then.
+   * @param ColorData the color data to update.
+   * @param Collection The collection being loaded.
+   * @param bIsPrimary If true, this is the primary color collection. Otherwise, it is the secondary collection.
    */
-  void OnVectorParameterUpdated(TPair<FName, FLinearColor> ParameterUpdate, bool bIsPrimary);
+  void WaitOnColorDataCollection(FUNCollectionColorData& ColorData, const TSoftObjectPtr<UMaterialParameterCollection>& Collection, bool bIsPrimary);
 
   /**
-   * A delegate called upon updating the primary color data.
-   * @param ParameterUpdate the parameter in the collection that was updated.
+   * Resolves the collection color for the slate widget as it paints, when ShouldResolveCollectionColorOnPaint.
+   * @returns Returns the collection color to display.
    */
-  void OnPrimaryParameterUpdated(TPair<FName, FLinearColor> ParameterUpdate);
+  FLinearColor ResolveCollectionColorOnPaint();
 
   /**
-   * A delegate called upon updating the secondary color data.
-   * @param ParameterUpdate the parameter in the collection that was updated.
+   * Gets the collection subsystem of this widget's world, if available.
+   * @returns Returns the collection subsystem, if available.
    */
-  void OnSecondaryParameterUpdated(TPair<FName, FLinearColor> ParameterUpdate);
+  UUNCollectionSubsystem* GetCollectionSubsystem() const;
+
+  /**
+   * Adds or updates this image's entry in the collection color pool, or removes it if the image can't be pooled.
+   * @param Color The collection color just computed by this image.
+   */
+  void UpdateColorPoolEntry(const FLinearColor& Color);
+
+  /** Removes this image's entry from the collection color pool, if it has one.*/
+  void RemoveFromColorPool();
 
   /**
    * Gets a material parameter collection's world instance, if available.
@@ -246,6 +646,31 @@ protected:
   UPROPERTY(EditAnywhere, Interp, BlueprintReadWrite, BlueprintSetter = SetCollectionLerpAlpha)
   float CollectionLerpAlpha;
 
+  // If true, unloaded collections are loaded asynchronously instead of hitching the game thread.
+  UPROPERTY(EditAnywhere, Category = "Collection Color")
+  bool bLoadCollectionsAsync;
+
+  // The color displayed while waiting on an async collection load.
+  UPROPERTY(EditAnywhere, Category = "Collection Color", meta = (EditCondition = "bLoadCollectionsAsync"))
+  FLinearColor AsyncPlaceholderColor;
+
+  // How much the collection color must change before the slate widget is updated and invalidated.
+  UPROPERTY(EditAnywhere, Category = "Collection Color")
+  EUNColorChangeTolerance CollectionColorTolerance;
+
+  // If true, parameter updates only mark the collection color dirty, and it is resolved on the next paint.
+  // Collapsed, hidden, and off-screen images then cost nothing while their collections animate.
+  UPROPERTY(EditAnywhere, Category = "Collection Color")
+  bool bResolveCollectionColorOnPaint;
+
+  // The stops of a gradient sampled by the CollectionLerpAlpha. If empty, the primary and secondary colors are used.
+  UPROPERTY(EditAnywhere, BlueprintReadOnly, BlueprintSetter = SetCollectionGradient, Category = "Collection Color")
+  TArray<FUNCollectionGradientStop> CollectionGradient;
+
+  // The number of samples in the gradient lookup table. More samples follow the stops more closely.
+  UPROPERTY(EditAnywhere, AdvancedDisplay, Category = "Collection Color", meta = (ClampMin = "2", ClampMax = "1024"))
+  int32 GradientLUTResolution;
+
   // The slate widget for the UN image.
   TSharedPtr<SUNImage> MyUNImage;
   
@@ -258,6 +683,53 @@ private:
   UPROPERTY(EditAnywhere)
   FUNCollectionColorData SecondaryCollectionColor;
 
+  // The collection scalar the render opacity is bound to. Unbound if its index is empty.
+  UPROPERTY(EditAnywhere, Category = "Collection Scalar")
+  FUNCollectionScalarData OpacityCollectionScalar;
+
+  // The collection scalar the CollectionLerpAlpha is bound to. Unbound if its index is empty.
+  UPROPERTY(EditAnywhere, Category = "Collection Scalar")
+  FUNCollectionScalarData LerpAlphaCollectionScalar;
+
+  // The color data of each gradient stop, sorted by position.
+  TArray<FUNCollectionColorData> GradientColorData;
+
+  // The position of each gradient stop, matching the GradientColorData.
+  TArray<float> GradientPositions;
+
+  // The gradient sampled at even steps. Sampling is a read of two neighbors, no matter how many stops there are.
+  mutable TArray<FLinearColor> GradientLUT;
+
+  // If true, a stop's color changed since the GradientLUT was built.
+  mutable bool bGradientLUTDirty;
+
   // The cached off final color being displayed for the collection color.
   FLinearColor CachedCollectionColor;
+
+  // If true, a collection is being loaded asynchronously, and the AsyncPlaceholderColor is displayed.
+  bool bWaitingOnCollections;
+
+  // If true, this image is queued to initialize its color data once its world is initialized.
+  bool bWaitingOnWorldInitialization;
+
+  // If true, the color data has been fully initialized at least once, and its bindings may be reusable.
+  bool bColorDataInitialized;
+
+  // The collection subsystem the color data is subscribed through. Cached on first use.
+  mutable TWeakObjectPtr<UUNCollectionSubsystem> CollectionSubsystem;
+
+  // The subscription slot of the PrimaryCollectionColor.
+  static constexpr int32 PrimarySlot = 0;
+
+  // The subscription slot of the SecondaryCollectionColor.
+  static constexpr int32 SecondarySlot = 1;
+
+  // The subscription slot of the first gradient stop. Each later stop uses the next slot.
+  static constexpr int32 GradientSlotOffset = 2;
+
+  // The scalar subscription slot of the OpacityCollectionScalar.
+  static constexpr int32 OpacityScalarSlot = 0;
+
+  // The scalar subscription slot of the LerpAlphaCollectionScalar.
+  static constexpr int32 LerpAlphaScalarSlot = 1;
 };
\ No newline at end of file
@@ -0,0 +1,96 @@
+﻿// "Copyright (C) Craig Williams, SlashParadox"
+
+#include "UNImageBatch.h"
+
+#include "SUNImageBatch.h"
+
+UUNImageBatch::UUNImageBatch(const FObjectInitializer& ObjectInitializer)
+  : Super(ObjectInitializer)
+{
+}
+
+void UUNImageBatch::SynchronizeProperties()
+{
+  Super::SynchronizeProperties();
+
+  if (MyUNImageBatch.IsValid())
+  {
+    MyUNImageBatch->SetInstances(Instances);
+    CalculateCachedCollectionColor();
+  }
+}
+
+void UUNImageBatch::ReleaseSlateResources(bool bReleaseChildren)
+{
+  Super::ReleaseSlateResources(bReleaseChildren);
+
+  MyUNImageBatch.Reset();
+}
+
+TSharedRef<SUNImage> UUNImageBatch::ConstructUNImage()
+{
+  MyUNImageBatch = SNew(SUNImageBatch);
+  return MyUNImageBatch.ToSharedRef();
+}
+
+void UUNImageBatch::CalculateCachedCollectionColor()
+{
+  // Each instance does its own lerp, so the base collection color is left untouched.
+  if (!MyUNImageBatch.IsValid())
+    return;
+
+  FLinearColor PrimaryColor;
+  FLinearColor SecondaryColor;
+  GetResolvedCollectionColors(PrimaryColor, SecondaryColor);
+
+  MyUNImageBatch->SetCollectionColors(PrimaryColor, SecondaryColor);
+}
+
+void UUNImageBatch::SetInstances(const TArray<FUNImageBatchInstance>& InInstances)
+{
+  Instances = InInstances;
+
+  if (MyUNImageBatch.IsValid())
+    MyUNImageBatch->SetInstances(Instances);
+}
+
+int32 UUNImageBatch::AddInstance(const FUNImageBatchInstance& Instance)
+{
+  const int32 Index = Instances.Add(Instance);
+
+  // Only the new instance is pushed, so building up a batch one instance at a time stays linear.
+  if (MyUNImageBatch.IsValid())
+    MyUNImageBatch->AddInstance(Instance);
+
+  return Index;
+}
+
+void UUNImageBatch::RemoveInstance(int32 InstanceIndex)
+{
+  if (!Instances.IsValidIndex(InstanceIndex))
+    return;
+
+  Instances.RemoveAt(InstanceIndex);
+
+  if (MyUNImageBatch.IsValid())
+    MyUNImageBatch->RemoveInstance(InstanceIndex);
+}
+
+void UUNImageBatch::ClearInstances()
+{
+  Instances.Reset();
+
+  if (MyUNImageBatch.IsValid())
+    MyUNImageBatch->SetInstances(Instances);
+}
+
+void UUNImageBatch::SetInstanceLerpAlpha(int32 InstanceIndex, float Alpha)
+{
+  if (!Instances.IsValidIndex(InstanceIndex))
+    return;
+
+  Instances[InstanceIndex].LerpAlpha = Alpha;
+
+  if (MyUNImageBatch.IsValid())
+    MyUNImageBatch->SetInstanceLerpAlpha(InstanceIndex, Alpha);
+}
\ No newline at end of file
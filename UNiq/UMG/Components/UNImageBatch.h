@@ -0,0 +1,118 @@
+﻿// "Copyright (C) Craig Williams, SlashParadox"
+
+#pragma once
+
+#include "UNImage.h"
+
+#include "UNImageBatch.generated.h"
+
+class SUNImageBatch;
+
+/**
+ * @struct FUNImageBatchInstance
+ * @brief A single quad drawn by a UUNImageBatch.
+ */
+USTRUCT(BlueprintType)
+struct FUNImageBatchInstance
+{
+  GENERATED_BODY()
+
+  FUNImageBatchInstance()
+    : Position(FVector2D::ZeroVector)
+    , Size(FVector2D(32.0f, 32.0f))
+    , LerpAlpha(0.0f)
+  {
+  }
+
+  FUNImageBatchInstance(const FVector2D& InPosition, const FVector2D& InSize, float InLerpAlpha)
+    : Position(InPosition)
+    , Size(InSize)
+    , LerpAlpha(InLerpAlpha)
+  {
+  }
+
+  // The local position of the instance within the batch.
+  UPROPERTY(EditAnywhere, BlueprintReadWrite)
+  FVector2D Position;
+
+  // The local size of the instance.
+  UPROPERTY(EditAnywhere, BlueprintReadWrite)
+  FVector2D Size;
+
+  // The linear interpolation alpha between the primary and secondary collection colors for this instance.
+  UPROPERTY(EditAnywhere, BlueprintReadWrite)
+  float LerpAlpha;
+};
+
+/**
+ * @class UUNImageBatch
+ * @brief A batched UUNImage. Draws many instances of one brush, sharing one pair of collection color bindings,
+ * in a single widget. Use this instead of many UUNImages for large icon grids and minimaps.
+ */
+UCLASS(BlueprintType, Blueprintable)
+class UNIQ_API UUNImageBatch : public UUNImage
+{
+  GENERATED_UCLASS_BODY()
+
+protected:
+  // Begin UWidget Interface
+  virtual void SynchronizeProperties() override;
+  virtual void ReleaseSlateResources(bool bReleaseChildren) override;
+  // End UWidget Interface
+
+  // Begin UUNImage Interface
+  virtual TSharedRef<SUNImage> ConstructUNImage() override;
+  virtual void CalculateCachedCollectionColor() override;
+  virtual bool ShouldResolveCollectionColorOnPaint() const override { return false; }
+  // End UUNImage Interface
+
+public:
+  /**
+   * Replaces all instances in the batch.
+   * @param InInstances The new instances.
+   */
+  UFUNCTION(BlueprintCallable, BlueprintCosmetic, Category = "Image Batch")
+  void SetInstances(const TArray<FUNImageBatchInstance>& InInstances);
+
+  /**
+   * Adds an instance to the batch.
+   * @param Instance The instance to add.
+   * @returns Returns the index of the new instance.
+   */
+  UFUNCTION(BlueprintCallable, BlueprintCosmetic, Category = "Image Batch")
+  int32 AddInstance(const FUNImageBatchInstance& Instance);
+
+  /**
+   * Removes an instance from the batch. Every instance after it moves down one index.
+   * @param InstanceIndex The index of the instance.
+   */
+  UFUNCTION(BlueprintCallable, BlueprintCosmetic, Category = "Image Batch")
+  void RemoveInstance(int32 InstanceIndex);
+
+  /** Removes all instances from the batch.*/
+  UFUNCTION(BlueprintCallable, BlueprintCosmetic, Category = "Image Batch")
+  void ClearInstances();
+
+  /**
+   * Sets the lerp alpha of a single instance. This only repaints the batch, without a layout pass.
+   * @param InstanceIndex The index of the instance.
+   * @param Alpha The linear interpolation alpha between the primary and secondary collection colors.
+   */
+  UFUNCTION(BlueprintCallable, BlueprintCosmetic, Category = "Image Batch")
+  void SetInstanceLerpAlpha(int32 InstanceIndex, float Alpha);
+
+  /**
+   * Gets all instances in the batch.
+   * @returns Returns the Instances.
+   */
+  UFUNCTION(BlueprintPure, Category = "Image Batch")
+  const TArray<FUNImageBatchInstance>& GetInstances() const { return Instances; }
+
+protected:
+  // The instances drawn by this batch.
+  UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Image Batch")
+  TArray<FUNImageBatchInstance> Instances;
+
+  // The slate widget for the UN image batch.
+  TSharedPtr<SUNImageBatch> MyUNImageBatch;
+};
\ No newline at end of file
@@ -2,23 +2,35 @@
 
 #include "UNInterpContainer.h"
 
+#include "Misc/CoreDelegates.h"
+#include "UNUpdateRecording.h"
+#include "Widgets/Layout/SSpacer.h"
+
+namespace UNInterpContainerPrivate
+{
+  // The containers with changes waiting to be broadcast.
+  static TArray<TWeakObjectPtr<UUNInterpContainer>> DeferredContainers;
+
+  // The shared handle to FCoreDelegates::OnEndFrame.
+  static FDelegateHandle EndFrameHandle;
+}
+
 UUNInterpContainer::UUNInterpContainer(const FObjectInitializer& ObjectInitializer)
   : Super(ObjectInitializer)
   , FloatValue(0.0f)
+  , Vector2DValue(FVector2D::ZeroVector)
+  , ColorValue(FLinearColor::White)
+  , bDeferBroadcasts(false)
+  , bFloatBroadcastPending(false)
+  , bVector2DBroadcastPending(false)
+  , bColorBroadcastPending(false)
 {
 }
 
 TSharedRef<SWidget> UUNInterpContainer::RebuildWidget()
 {
-  MyBox = SNew(SBox);
-  return MyBox.ToSharedRef();
-}
-
-void UUNInterpContainer::ReleaseSlateResources(bool bReleaseChildren)
-{
-  Super::ReleaseSlateResources(bReleaseChildren);
-
-  MyBox.Reset();
+  // Nothing is drawn, but UWidget pushes its settings onto whatever is returned, so it can't be a shared widget.
+  return SNew(SSpacer).Size(FVector2D::ZeroVector);
 }
 
 void UUNInterpContainer::SetFloatValue(float Value)
@@ -27,5 +39,109 @@ void UUNInterpContainer::SetFloatValue(float Value)
     return;
 
   FloatValue = Value;
+  if (FUNUpdateRecorder* Recorder = FUNUpdateRecorder::GetActive())
+    Recorder->RecordInterpFloat(this, FloatValue);
+
+  if (DeferBroadcast(bFloatBroadcastPending))
+    return;
+
+  OnFloatValueChangedNative.Broadcast(FloatValue);
   OnFloatValueChanged.Broadcast(FloatValue);
+}
+
+void UUNInterpContainer::SetVector2DValue(FVector2D Value)
+{
+  if (Vector2DValue.Equals(Value))
+    return;
+
+  Vector2DValue = Value;
+  if (FUNUpdateRecorder* Recorder = FUNUpdateRecorder::GetActive())
+    Recorder->RecordInterpVector2D(this, Vector2DValue);
+
+  if (DeferBroadcast(bVector2DBroadcastPending))
+    return;
+
+  OnVector2DValueChangedNative.Broadcast(Vector2DValue);
+  OnVector2DValueChanged.Broadcast(Vector2DValue);
+}
+
+void UUNInterpContainer::SetColorValue(FLinearColor Value)
+{
+  if (ColorValue.Equals(Value))
+    return;
+
+  ColorValue = Value;
+  if (FUNUpdateRecorder* Recorder = FUNUpdateRecorder::GetActive())
+    Recorder->RecordInterpColor(this, ColorValue);
+
+  if (DeferBroadcast(bColorBroadcastPending))
+    return;
+
+  OnColorValueChangedNative.Broadcast(ColorValue);
+  OnColorValueChanged.Broadcast(ColorValue);
+}
+
+void UUNInterpContainer::FlushDeferredBroadcasts()
+{
+  using namespace UNInterpContainerPrivate;
+
+  // Listeners may change values while broadcasting. Those go into a fresh list, for the next flush.
+  TArray<TWeakObjectPtr<UUNInterpContainer>> Containers = MoveTemp(DeferredContainers);
+  DeferredContainers.Reset();
+
+  for (const TWeakObjectPtr<UUNInterpContainer>& Container : Containers)
+  {
+    if (UUNInterpContainer* ContainerPtr = Container.Get())
+      ContainerPtr->BroadcastDeferredValues();
+  }
+
+  if (DeferredContainers.IsEmpty() && EndFrameHandle.IsValid())
+  {
+    FCoreDelegates::OnEndFrame.Remove(EndFrameHandle);
+    EndFrameHandle.Reset();
+  }
+}
+
+bool UUNInterpContainer::DeferBroadcast(bool& bBroadcastPending)
+{
+  using namespace UNInterpContainerPrivate;
+
+  if (!bDeferBroadcasts)
+    return false;
+
+  // Only queue the container once, no matter how many of its values change.
+  if (!bFloatBroadcastPending && !bVector2DBroadcastPending && !bColorBroadcastPending)
+  {
+    DeferredContainers.Add(this);
+
+    if (!EndFrameHandle.IsValid())
+      EndFrameHandle = FCoreDelegates::OnEndFrame.AddStatic(&UUNInterpContainer::FlushDeferredBroadcasts);
+  }
+
+  bBroadcastPending = true;
+  return true;
+}
+
+void UUNInterpContainer::BroadcastDeferredValues()
+{
+  if (bFloatBroadcastPending)
+  {
+    bFloatBroadcastPending = false;
+    OnFloatValueChangedNative.Broadcast(FloatValue);
+    OnFloatValueChanged.Broadcast(FloatValue);
+  }
+
+  if (bVector2DBroadcastPending)
+  {
+    bVector2DBroadcastPending = false;
+    OnVector2DValueChangedNative.Broadcast(Vector2DValue);
+    OnVector2DValueChanged.Broadcast(Vector2DValue);
+  }
+
+  if (bColorBroadcastPending)
+  {
+    bColorBroadcastPending = false;
+    OnColorValueChangedNative.Broadcast(ColorValue);
+    OnColorValueChanged.Broadcast(ColorValue);
+  }
 }
\ No newline at end of file
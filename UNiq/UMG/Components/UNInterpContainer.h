@@ -6,11 +6,20 @@
 #include "UNInterpContainer.generated.h"
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FInterpFloatEvent, float, CurrentValue);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FInterpVector2DEvent, FVector2D, CurrentValue);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FInterpColorEvent, FLinearColor, CurrentValue);
+
+DECLARE_MULTICAST_DELEGATE_OneParam(FInterpFloatNativeEvent, float);
+DECLARE_MULTICAST_DELEGATE_OneParam(FInterpVector2DNativeEvent, const FVector2D&);
+DECLARE_MULTICAST_DELEGATE_OneParam(FInterpColorNativeEvent, const FLinearColor&);
 
 /**
  * @class UUNInterpContainer
  * @brief A simple, formless widget that is solely for use in widget animations. Interp its values
- * to give more freedom on changing user-set values.
+ * to give more freedom on changing user-set values. Each value has a dynamic delegate for Blueprints,
+ * and a native delegate that reaches C++ without going through the Blueprint VM. Only an empty spacer is
+ * built for it, the cheapest leaf widget that can still take its own slate settings.
+ * With bDeferBroadcasts set, changes are broadcast once at the end of the frame, with their final values.
  */
 UCLASS()
 class UNIQ_API UUNInterpContainer : public UWidget
@@ -22,26 +31,101 @@ public:
   virtual TSharedRef<SWidget> RebuildWidget() override;
   // End UWidget class
 
-protected:
-  // Begin UWidget class
-  virtual void ReleaseSlateResources(bool bReleaseChildren) override;
-  // End UWidget class
-
 public:
   /** Sets the FloatValue, and calls an event.*/
   UFUNCTION(BlueprintCallable)
   void SetFloatValue(float Value);
 
+  /** Sets the Vector2DValue, and calls an event.*/
+  UFUNCTION(BlueprintCallable)
+  void SetVector2DValue(FVector2D Value);
+
+  /** Sets the ColorValue, and calls an event.*/
+  UFUNCTION(BlueprintCallable)
+  void SetColorValue(FLinearColor Value);
+
+  /**
+   * Gets the FloatValue.
+   * @returns Returns the FloatValue.
+   */
+  UFUNCTION(BlueprintPure)
+  float GetFloatValue() const { return FloatValue; }
+
+  /**
+   * Gets the Vector2DValue.
+   * @returns Returns the Vector2DValue.
+   */
+  UFUNCTION(BlueprintPure)
+  FVector2D GetVector2DValue() const { return Vector2DValue; }
+
+  /**
+   * Gets the ColorValue.
+   * @returns Returns the ColorValue.
+   */
+  UFUNCTION(BlueprintPure)
+  FLinearColor GetColorValue() const { return ColorValue; }
+
+  /** Immediately broadcasts every change deferred by any container. Otherwise, they are broadcast at the end of the frame.*/
+  UFUNCTION(BlueprintCallable, Category = "Interp Container")
+  static void FlushDeferredBroadcasts();
+
   // A delegate called when FloatValue changes.
   UPROPERTY(BlueprintAssignable)
   FInterpFloatEvent OnFloatValueChanged;
 
+  // A delegate called when Vector2DValue changes.
+  UPROPERTY(BlueprintAssignable)
+  FInterpVector2DEvent OnVector2DValueChanged;
+
+  // A delegate called when ColorValue changes.
+  UPROPERTY(BlueprintAssignable)
+  FInterpColorEvent OnColorValueChanged;
+
+  // A native delegate called when FloatValue changes.
+  FInterpFloatNativeEvent OnFloatValueChangedNative;
+
+  // A native delegate called when Vector2DValue changes.
+  FInterpVector2DNativeEvent OnVector2DValueChangedNative;
+
+  // A native delegate called when ColorValue changes.
+  FInterpColorNativeEvent OnColorValueChangedNative;
+
 protected:
   // An interpretable FloatValue. Animate this in widgets.
   UPROPERTY(BlueprintReadWrite, EditAnywhere, Interp, BlueprintSetter=SetFloatValue)
   float FloatValue;
 
+  // An interpretable Vector2DValue. Animate this in widgets.
+  UPROPERTY(BlueprintReadWrite, EditAnywhere, Interp, BlueprintSetter=SetVector2DValue)
+  FVector2D Vector2DValue;
+
+  // An interpretable ColorValue. Animate this in widgets.
+  UPROPERTY(BlueprintReadWrite, EditAnywhere, Interp, BlueprintSetter=SetColorValue)
+  FLinearColor ColorValue;
+
+  // If true, value changes are broadcast once at the end of the frame instead of immediately. Use this when an
+  // animation may set values several times a frame, and listeners only care about the final one.
+  UPROPERTY(BlueprintReadWrite, EditAnywhere)
+  bool bDeferBroadcasts;
+
 private:
-  // The simplest widget possible to use for a low footprint.
-  TSharedPtr<SBox> MyBox;
+  /**
+   * Defers the broadcast of a value change to the end of the frame, if bDeferBroadcasts is set.
+   * @param bBroadcastPending The pending flag of the changed value.
+   * @returns Returns true if the broadcast was deferred, and should not be made now.
+   */
+  bool DeferBroadcast(bool& bBroadcastPending);
+
+  /** Broadcasts every value with a deferred change.*/
+  void BroadcastDeferredValues();
+
+private:
+  // If true, a FloatValue change is waiting to be broadcast.
+  bool bFloatBroadcastPending;
+
+  // If true, a Vector2DValue change is waiting to be broadcast.
+  bool bVector2DBroadcastPending;
+
+  // If true, a ColorValue change is waiting to be broadcast.
+  bool bColorBroadcastPending;
 };
\ No newline at end of file
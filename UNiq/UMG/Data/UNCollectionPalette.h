@@ -0,0 +1,60 @@
+﻿// "Copyright (C) Craig Williams, SlashParadox"
+
+#pragma once
+
+#include "Engine/DataAsset.h"
+
+#include "UNCollectionPalette.generated.h"
+
+class UMaterialParameterCollection;
+
+/**
+ * @struct FUNCollectionPaletteColor
+ * @brief A single color of a palette, written to a vector parameter of a collection.
+ */
+USTRUCT(BlueprintType)
+struct FUNCollectionPaletteColor
+{
+  GENERATED_BODY()
+
+  FUNCollectionPaletteColor()
+    : Collection(nullptr)
+    , Color(FLinearColor::White)
+  {
+  }
+
+  // The parameter collection to write the color to.
+  UPROPERTY(EditAnywhere, BlueprintReadWrite)
+  TObjectPtr<UMaterialParameterCollection> Collection;
+
+  // The name of the vector parameter in the Collection.
+  UPROPERTY(EditAnywhere, BlueprintReadWrite)
+  FName ParameterName;
+
+  // The color to write.
+  UPROPERTY(EditAnywhere, BlueprintReadWrite)
+  FLinearColor Color;
+};
+
+/**
+ * @class UUNCollectionPalette
+ * @brief A set of collection colors that are swapped in together, such as a UI theme or a colorblind mode.
+ * Apply it through UUNCollectionSubsystem::ApplyPalette, so every affected listener is only updated once.
+ */
+UCLASS(BlueprintType)
+class UNIQ_API UUNCollectionPalette : public UDataAsset
+{
+  GENERATED_BODY()
+
+public:
+  /**
+   * Gets the colors of the palette.
+   * @returns Returns the colors. If a parameter is listed more than once, the last color wins.
+   */
+  const TArray<FUNCollectionPaletteColor>& GetColors() const { return Colors; }
+
+protected:
+  // The colors of the palette. Collections are hard references, so they are loaded along with the palette.
+  UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Palette")
+  TArray<FUNCollectionPaletteColor> Colors;
+};
\ No newline at end of file
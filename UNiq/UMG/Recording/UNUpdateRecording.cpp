@@ -0,0 +1,721 @@
+﻿// "Copyright (C) Craig Williams, SlashParadox"
+
+#include "UNUpdateRecording.h"
+
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "Materials/MaterialParameterCollection.h"
+#include "Materials/MaterialParameterCollectionInstance.h"
+#include "Misc/CoreDelegates.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryReader.h"
+#include "UNCollectionSubsystem.h"
+#include "UNImage.h"
+#include "UNInterpContainer.h"
+
+namespace UNUpdateRecordingPrivate
+{
+  // The first bytes of every recording. "UNRC", little endian.
+  static constexpr uint32 FileMagic = 0x43524E55;
+
+  // The version of the recording format.
+  static constexpr uint32 FileVersion = 1;
+
+  // The running recorder, if any.
+  static FUNUpdateRecorder* ActiveRecorder = nullptr;
+
+  // The replay started from the console, if any.
+  static TUniquePtr<FUNUpdateReplay> ConsoleReplay;
+
+  /**
+   * Reads a color written as four floats.
+   * @param Reader The archive to read from.
+   * @returns Returns the color.
+   */
+  static FLinearColor ReadColor(FArchive& Reader)
+  {
+    FLinearColor Color;
+    Reader << Color.R << Color.G << Color.B << Color.A;
+    return Color;
+  }
+
+  /**
+   * Reads a reference to a name, adding the name if this is its first use.
+   * @param Reader The archive to read from.
+   * @param Names The names read so far.
+   * @returns Returns the name's index, or INDEX_NONE if the reference is invalid.
+   */
+  static int32 ReadName(FArchive& Reader, TArray<FString>& Names)
+  {
+    uint32 Index = 0;
+    Reader.SerializeIntPacked(Index);
+
+    if (Index < static_cast<uint32>(Names.Num()))
+      return static_cast<int32>(Index);
+
+    // Names are written in full on their first use, which is always the next index.
+    if (Index != static_cast<uint32>(Names.Num()))
+      return INDEX_NONE;
+
+    FString Name;
+    Reader << Name;
+    return Names.Add(MoveTemp(Name));
+  }
+
+  /**
+   * Starts a recording from the console.
+   * @param Args An optional path to write the recording to.
+   * @param World The world to record.
+   */
+  static void StartRecording(const TArray<FString>& Args, UWorld* World)
+  {
+    const FString Path = !Args.IsEmpty() ? Args[0] : FPaths::Combine(FPaths::ProfilingDir(), TEXT("UNiq"), FString::Printf(TEXT("UNRecording_%s.unrec"), *FDateTime::Now().ToString()));
+
+    if (FUNUpdateRecorder::Start(World, Path))
+      UE_LOG(LogSlate, Display, TEXT("[%s] Recording started. Path: [%s]"), *FString(__FUNCTION__), *Path);
+  }
+
+  /**
+   * Stops the running recording from the console.
+   * @param Args Unused.
+   * @param World Unused.
+   */
+  static void StopRecording(const TArray<FString>& Args, UWorld* World)
+  {
+    FUNUpdateRecorder::Stop();
+  }
+
+  /**
+   * Replays a recording from the console.
+   * @param Args The path of the recording, and optionally "RealTime" to replay it in real time.
+   * @param World The world to replay into.
+   */
+  static void Replay(const TArray<FString>& Args, UWorld* World)
+  {
+    if (Args.IsEmpty())
+    {
+      UE_LOG(LogSlate, Warning, TEXT("[%s] Usage: UN.Recording.Replay <Path> [RealTime]"), *FString(__FUNCTION__));
+      return;
+    }
+
+    ConsoleReplay = MakeUnique<FUNUpdateReplay>();
+    if (!ConsoleReplay->Load(Args[0]))
+    {
+      ConsoleReplay.Reset();
+      return;
+    }
+
+    if (Args.IsValidIndex(1) && Args[1].Equals(TEXT("RealTime"), ESearchCase::IgnoreCase))
+    {
+      ConsoleReplay->StartRealTime(World);
+      return;
+    }
+
+    const double StartTime = FPlatformTime::Seconds();
+    const int32 NumApplied = ConsoleReplay->ReplayAll(World);
+    const double ElapsedMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+
+    UE_LOG(LogSlate, Display, TEXT("[%s] Replayed [%d] updates over [%d] frames in [%.3f] ms. Recorded length: [%.3f] s"), *FString(__FUNCTION__), NumApplied, ConsoleReplay->GetNumFrames(), ElapsedMs, ConsoleReplay->GetDuration());
+
+    ConsoleReplay.Reset();
+  }
+
+  /**
+   * Stops a real time replay started from the console.
+   * @param Args Unused.
+   * @param World Unused.
+   */
+  static void StopReplay(const TArray<FString>& Args, UWorld* World)
+  {
+    ConsoleReplay.Reset();
+  }
+
+  static FAutoConsoleCommandWithWorldAndArgs StartRecordingCommand(
+    TEXT("UN.Recording.Start"),
+    TEXT("Records collection parameter updates and UNiq widget value changes in this world. Args: [Path]"),
+    FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&StartRecording));
+
+  static FAutoConsoleCommandWithWorldAndArgs StopRecordingCommand(
+    TEXT("UN.Recording.Stop"),
+    TEXT("Stops the running recording, and writes it to its file."),
+    FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&StopRecording));
+
+  static FAutoConsoleCommandWithWorldAndArgs ReplayCommand(
+    TEXT("UN.Recording.Replay"),
+    TEXT("Replays a recording into this world, at full speed unless RealTime is given. Args: <Path> [RealTime]"),
+    FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&Replay));
+
+  static FAutoConsoleCommandWithWorldAndArgs StopReplayCommand(
+    TEXT("UN.Recording.StopReplay"),
+    TEXT("Stops a real time replay started with UN.Recording.Replay."),
+    FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&StopReplay));
+}
+
+FUNUpdateRecorder::FUNUpdateRecorder(const FString& InPath)
+  : Path(InPath)
+  , Writer(Data)
+  , StartTime(FPlatformTime::Seconds())
+  , LastUpdateMicroseconds(0)
+  , bUpdatedThisFrame(false)
+{
+  uint32 Magic = UNUpdateRecordingPrivate::FileMagic;
+  uint32 Version = UNUpdateRecordingPrivate::FileVersion;
+  Writer << Magic << Version;
+}
+
+FUNUpdateRecorder::~FUNUpdateRecorder()
+{
+  UnbindInstances();
+
+  if (EndFrameHandle.IsValid())
+    FCoreDelegates::OnEndFrame.Remove(EndFrameHandle);
+
+  if (WorldCleanupHandle.IsValid())
+    FWorldDelegates::OnWorldCleanup.Remove(WorldCleanupHandle);
+}
+
+bool FUNUpdateRecorder::Start(UWorld* World, const FString& Path)
+{
+  using namespace UNUpdateRecordingPrivate;
+
+  check(IsInGameThread());
+
+  if (!World)
+  {
+    UE_LOG(LogSlate, Error, TEXT("[%s] No world to record!"), *FString(__FUNCTION__));
+    return false;
+  }
+
+  if (ActiveRecorder)
+  {
+    UE_LOG(LogSlate, Warning, TEXT("[%s] A recording is already running! Path: [%s]"), *FString(__FUNCTION__), *ActiveRecorder->Path);
+    return false;
+  }
+
+  ActiveRecorder = new FUNUpdateRecorder(Path);
+  ActiveRecorder->RecordedWorld = World;
+  ActiveRecorder->BindInstances(World);
+  ActiveRecorder->EndFrameHandle = FCoreDelegates::OnEndFrame.AddRaw(ActiveRecorder, &FUNUpdateRecorder::OnEndFrame);
+  ActiveRecorder->WorldCleanupHandle = FWorldDelegates::OnWorldCleanup.AddStatic(&FUNUpdateRecorder::OnWorldCleanup);
+  return true;
+}
+
+bool FUNUpdateRecorder::Stop()
+{
+  using namespace UNUpdateRecordingPrivate;
+
+  if (!ActiveRecorder)
+    return false;
+
+  const TUniquePtr<FUNUpdateRecorder> Recorder(ActiveRecorder);
+  ActiveRecorder = nullptr;
+
+  // Close off the last frame, so the replay flushes it.
+  Recorder->OnEndFrame();
+
+  if (!FFileHelper::SaveArrayToFile(Recorder->Data, *Recorder->Path))
+  {
+    UE_LOG(LogSlate, Error, TEXT("[%s] Unable to write recording! Path: [%s]"), *FString(__FUNCTION__), *Recorder->Path);
+    return false;
+  }
+
+  UE_LOG(LogSlate, Display, TEXT("[%s] Recording written. Path: [%s] Bytes: [%d]"), *FString(__FUNCTION__), *Recorder->Path, Recorder->Data.Num());
+  return true;
+}
+
+FUNUpdateRecorder* FUNUpdateRecorder::GetActive()
+{
+  return UNUpdateRecordingPrivate::ActiveRecorder;
+}
+
+void FUNUpdateRecorder::RecordImageLerpAlpha(const UObject* Image, float Alpha)
+{
+  if (!IsInRecordedWorld(Image))
+    return;
+
+  WriteUpdateHeader(EUNRecordedUpdateType::ImageLerpAlpha);
+  WriteWidgetName(Image);
+  Writer << Alpha;
+}
+
+void FUNUpdateRecorder::RecordInterpFloat(const UObject* Container, float Value)
+{
+  if (!IsInRecordedWorld(Container))
+    return;
+
+  WriteUpdateHeader(EUNRecordedUpdateType::InterpFloat);
+  WriteWidgetName(Container);
+  Writer << Value;
+}
+
+void FUNUpdateRecorder::RecordInterpVector2D(const UObject* Container, const FVector2D& Value)
+{
+  if (!IsInRecordedWorld(Container))
+    return;
+
+  WriteUpdateHeader(EUNRecordedUpdateType::InterpVector2D);
+  WriteWidgetName(Container);
+
+  // Widget values never need double precision, so they're kept as small as the rest of the file.
+  float X = static_cast<float>(Value.X);
+  float Y = static_cast<float>(Value.Y);
+  Writer << X << Y;
+}
+
+void FUNUpdateRecorder::RecordInterpColor(const UObject* Container, const FLinearColor& Value)
+{
+  if (!IsInRecordedWorld(Container))
+    return;
+
+  WriteUpdateHeader(EUNRecordedUpdateType::InterpColor);
+  WriteWidgetName(Container);
+  WriteColor(Value);
+}
+
+void FUNUpdateRecorder::BindInstances(UWorld* World)
+{
+  for (UMaterialParameterCollectionInstance* Instance : World->ParameterCollectionInstances)
+  {
+    if (!Instance || !Instance->GetCollection())
+      continue;
+
+    const int32 BindingIndex = InstanceBindings.AddDefaulted();
+    FInstanceBinding& Binding = InstanceBindings[BindingIndex];
+
+    // Collection paths are written on their first update, like every other name.
+    Binding.Instance = Instance;
+    Binding.CollectionPath = Instance->GetCollection()->GetPathName();
+    Binding.VectorDelegateHandle = Instance->OnVectorParameterUpdated().AddRaw(this, &FUNUpdateRecorder::OnVectorParameterUpdated, BindingIndex);
+    Binding.ScalarDelegateHandle = Instance->OnScalarParameterUpdated().AddRaw(this, &FUNUpdateRecorder::OnScalarParameterUpdated, BindingIndex);
+  }
+}
+
+void FUNUpdateRecorder::UnbindInstances()
+{
+  for (const FInstanceBinding& Binding : InstanceBindings)
+  {
+    if (UMaterialParameterCollectionInstance* Instance = Binding.Instance.Get())
+    {
+      Instance->OnVectorParameterUpdated().Remove(Binding.VectorDelegateHandle);
+      Instance->OnScalarParameterUpdated().Remove(Binding.ScalarDelegateHandle);
+    }
+  }
+
+  InstanceBindings.Empty();
+}
+
+bool FUNUpdateRecorder::IsInRecordedWorld(const UObject* Widget) const
+{
+  return Widget && TObjectKey<UWorld>(Widget->GetWorld()) == RecordedWorld;
+}
+
+void FUNUpdateRecorder::OnWorldCleanup(UWorld* World, bool bSessionEnded, bool bCleanupResources)
+{
+  using namespace UNUpdateRecordingPrivate;
+
+  // Write what was recorded while the world is still around, instead of holding bindings into a dead world.
+  if (ActiveRecorder && ActiveRecorder->RecordedWorld == TObjectKey<UWorld>(World))
+    Stop();
+}
+
+void FUNUpdateRecorder::OnVectorParameterUpdated(TPair<FName, FLinearColor> ParameterUpdate, int32 BindingIndex)
+{
+  WriteUpdateHeader(EUNRecordedUpdateType::CollectionVector);
+  WriteCollectionName(InstanceBindings[BindingIndex]);
+  WriteParameterName(ParameterUpdate.Key);
+  WriteColor(ParameterUpdate.Value);
+}
+
+void FUNUpdateRecorder::OnScalarParameterUpdated(TPair<FName, float> ParameterUpdate, int32 BindingIndex)
+{
+  WriteUpdateHeader(EUNRecordedUpdateType::CollectionScalar);
+  WriteCollectionName(InstanceBindings[BindingIndex]);
+  WriteParameterName(ParameterUpdate.Key);
+  Writer << ParameterUpdate.Value;
+}
+
+void FUNUpdateRecorder::OnEndFrame()
+{
+  // Frames without updates are left out. Their time is still in the delta of the next update.
+  if (!bUpdatedThisFrame)
+    return;
+
+  WriteUpdateHeader(EUNRecordedUpdateType::Frame);
+  bUpdatedThisFrame = false;
+}
+
+void FUNUpdateRecorder::WriteUpdateHeader(EUNRecordedUpdateType Type)
+{
+  const uint64 NowMicroseconds = static_cast<uint64>((FPlatformTime::Seconds() - StartTime) * 1000000.0);
+  uint32 DeltaMicroseconds = static_cast<uint32>(FMath::Min<uint64>(NowMicroseconds - FMath::Min(LastUpdateMicroseconds, NowMicroseconds), MAX_uint32));
+  LastUpdateMicroseconds = NowMicroseconds;
+
+  uint8 TypeByte = static_cast<uint8>(Type);
+  Writer << TypeByte;
+  Writer.SerializeIntPacked(DeltaMicroseconds);
+
+  if (Type != EUNRecordedUpdateType::Frame)
+    bUpdatedThisFrame = true;
+}
+
+int32 FUNUpdateRecorder::WriteName(const FString& Name)
+{
+  if (const int32* ExistingIndex = NameIndices.Find(Name))
+  {
+    WriteNameIndex(*ExistingIndex);
+    return *ExistingIndex;
+  }
+
+  // The reader knows how many names it has, so an index one past them means the name follows in full.
+  const int32 Index = NameIndices.Num();
+  NameIndices.Add(Name, Index);
+
+  FString NameToWrite = Name;
+  WriteNameIndex(Index);
+  Writer << NameToWrite;
+  return Index;
+}
+
+void FUNUpdateRecorder::WriteNameIndex(int32 Index)
+{
+  uint32 PackedIndex = static_cast<uint32>(Index);
+  Writer.SerializeIntPacked(PackedIndex);
+}
+
+void FUNUpdateRecorder::WriteCollectionName(FInstanceBinding& Binding)
+{
+  if (Binding.CollectionIndex != INDEX_NONE)
+  {
+    WriteNameIndex(Binding.CollectionIndex);
+    return;
+  }
+
+  Binding.CollectionIndex = WriteName(Binding.CollectionPath);
+}
+
+void FUNUpdateRecorder::WriteWidgetName(const UObject* Widget)
+{
+  const TObjectKey<UObject> WidgetKey(Widget);
+  if (const int32* ExistingIndex = WidgetNameIndices.Find(WidgetKey))
+  {
+    WriteNameIndex(*ExistingIndex);
+    return;
+  }
+
+  WidgetNameIndices.Add(WidgetKey, WriteName(GetPathNameSafe(Widget)));
+}
+
+void FUNUpdateRecorder::WriteParameterName(const FName& ParameterName)
+{
+  if (const int32* ExistingIndex = ParameterNameIndices.Find(ParameterName))
+  {
+    WriteNameIndex(*ExistingIndex);
+    return;
+  }
+
+  ParameterNameIndices.Add(ParameterName, WriteName(ParameterName.ToString()));
+}
+
+void FUNUpdateRecorder::WriteColor(FLinearColor Color)
+{
+  Writer << Color.R << Color.G << Color.B << Color.A;
+}
+
+FUNUpdateReplay::FUNUpdateReplay()
+  : NumFrames(0)
+  , NextUpdate(0)
+  , PlaybackStartTime(0.0)
+{
+  WidgetResolver = [](const FString& Path) { return FindObject<UObject>(nullptr, *Path); };
+}
+
+FUNUpdateReplay::~FUNUpdateReplay()
+{
+  Stop();
+}
+
+bool FUNUpdateReplay::Load(const FString& Path)
+{
+  using namespace UNUpdateRecordingPrivate;
+
+  Stop();
+  Names.Reset();
+  ParameterNames.Reset();
+  Updates.Reset();
+  NumFrames = 0;
+
+  TArray<uint8> Data;
+  if (!FFileHelper::LoadFileToArray(Data, *Path))
+  {
+    UE_LOG(LogSlate, Error, TEXT("[%s] Unable to read recording! Path: [%s]"), *FString(__FUNCTION__), *Path);
+    return false;
+  }
+
+  FMemoryReader Reader(Data);
+
+  uint32 Magic = 0;
+  uint32 Version = 0;
+  Reader << Magic << Version;
+
+  if (Reader.IsError() || Magic != FileMagic || Version != FileVersion)
+  {
+    UE_LOG(LogSlate, Error, TEXT("[%s] Not a recording of a supported version! Path: [%s] Version: [%u]"), *FString(__FUNCTION__), *Path, Version);
+    return false;
+  }
+
+  // Everything is parsed up front, so replaying is only the updates themselves.
+  uint64 TimeMicroseconds = 0;
+
+  while (!Reader.AtEnd() && !Reader.IsError())
+  {
+    uint8 TypeByte = 0;
+    uint32 DeltaMicroseconds = 0;
+    Reader << TypeByte;
+    Reader.SerializeIntPacked(DeltaMicroseconds);
+
+    if (TypeByte >= static_cast<uint8>(EUNRecordedUpdateType::Count))
+    {
+      Reader.SetError();
+      break;
+    }
+
+    TimeMicroseconds += DeltaMicroseconds;
+
+    FUNRecordedUpdate& Update = Updates.AddDefaulted_GetRef();
+    Update.Time = static_cast<double>(TimeMicroseconds) / 1000000.0;
+    Update.Type = static_cast<EUNRecordedUpdateType>(TypeByte);
+
+    switch (Update.Type)
+    {
+    case EUNRecordedUpdateType::Frame:
+      ++NumFrames;
+      break;
+    case EUNRecordedUpdateType::CollectionVector:
+      Update.TargetIndex = ReadName(Reader, Names);
+      Update.ParameterIndex = ReadName(Reader, Names);
+      Update.Value = ReadColor(Reader);
+      break;
+    case EUNRecordedUpdateType::CollectionScalar:
+      Update.TargetIndex = ReadName(Reader, Names);
+      Update.ParameterIndex = ReadName(Reader, Names);
+      Reader << Update.Value.R;
+      break;
+    case EUNRecordedUpdateType::ImageLerpAlpha:
+    case EUNRecordedUpdateType::InterpFloat:
+      Update.TargetIndex = ReadName(Reader, Names);
+      Reader << Update.Value.R;
+      break;
+    case EUNRecordedUpdateType::InterpVector2D:
+      Update.TargetIndex = ReadName(Reader, Names);
+      Reader << Update.Value.R << Update.Value.G;
+      break;
+    case EUNRecordedUpdateType::InterpColor:
+      Update.TargetIndex = ReadName(Reader, Names);
+      Update.Value = ReadColor(Reader);
+      break;
+    default:
+      break;
+    }
+
+    const bool bIsCollectionUpdate = Update.Type == EUNRecordedUpdateType::CollectionVector || Update.Type == EUNRecordedUpdateType::CollectionScalar;
+    if (Update.Type != EUNRecordedUpdateType::Frame && (Update.TargetIndex == INDEX_NONE || (bIsCollectionUpdate && Update.ParameterIndex == INDEX_NONE)))
+      Reader.SetError();
+  }
+
+  if (Reader.IsError())
+  {
+    UE_LOG(LogSlate, Error, TEXT("[%s] Recording is corrupt! Path: [%s] Updates Read: [%d]"), *FString(__FUNCTION__), *Path, Updates.Num());
+    Names.Reset();
+    Updates.Reset();
+    NumFrames = 0;
+    return false;
+  }
+
+  ParameterNames.Reserve(Names.Num());
+  for (const FString& Name : Names)
+  {
+    ParameterNames.Emplace(*Name);
+  }
+
+  return true;
+}
+
+int32 FUNUpdateReplay::ReplayAll(UWorld* InWorld)
+{
+  Stop();
+
+  if (!InWorld)
+    return 0;
+
+  ResetTargets(InWorld);
+
+  int32 NumApplied = 0;
+  for (const FUNRecordedUpdate& Update : Updates)
+  {
+    if (Update.Type == EUNRecordedUpdateType::Frame)
+      EndFrame();
+    else if (ApplyUpdate(Update))
+      ++NumApplied;
+  }
+
+  EndFrame();
+  return NumApplied;
+}
+
+bool FUNUpdateReplay::StartRealTime(UWorld* InWorld)
+{
+  Stop();
+
+  if (!InWorld || Updates.IsEmpty())
+    return false;
+
+  ResetTargets(InWorld);
+  NextUpdate = 0;
+  PlaybackStartTime = FPlatformTime::Seconds();
+  TickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateRaw(this, &FUNUpdateReplay::Tick));
+  return true;
+}
+
+void FUNUpdateReplay::Stop()
+{
+  if (!TickerHandle.IsValid())
+    return;
+
+  FTSTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+  TickerHandle.Reset();
+}
+
+bool FUNUpdateReplay::ApplyUpdate(const FUNRecordedUpdate& Update)
+{
+  switch (Update.Type)
+  {
+  case EUNRecordedUpdateType::CollectionVector:
+    if (UMaterialParameterCollectionInstance* Instance = ResolveCollectionInstance(Update.TargetIndex))
+      return Instance->SetVectorParameterValue(ParameterNames[Update.ParameterIndex], Update.Value);
+    break;
+  case EUNRecordedUpdateType::CollectionScalar:
+    if (UMaterialParameterCollectionInstance* Instance = ResolveCollectionInstance(Update.TargetIndex))
+      return Instance->SetScalarParameterValue(ParameterNames[Update.ParameterIndex], Update.Value.R);
+    break;
+  case EUNRecordedUpdateType::ImageLerpAlpha:
+    if (UUNImage* Image = Cast<UUNImage>(ResolveWidget(Update.TargetIndex)))
+    {
+      Image->SetCollectionLerpAlpha(Update.Value.R);
+      return true;
+    }
+    break;
+  case EUNRecordedUpdateType::InterpFloat:
+    if (UUNInterpContainer* Container = Cast<UUNInterpContainer>(ResolveWidget(Update.TargetIndex)))
+    {
+      Container->SetFloatValue(Update.Value.R);
+      return true;
+    }
+    break;
+  case EUNRecordedUpdateType::InterpVector2D:
+    if (UUNInterpContainer* Container = Cast<UUNInterpContainer>(ResolveWidget(Update.TargetIndex)))
+    {
+      Container->SetVector2DValue(FVector2D(Update.Value.R, Update.Value.G));
+      return true;
+    }
+    break;
+  case EUNRecordedUpdateType::InterpColor:
+    if (UUNInterpContainer* Container = Cast<UUNInterpContainer>(ResolveWidget(Update.TargetIndex)))
+    {
+      Container->SetColorValue(Update.Value);
+      return true;
+    }
+    break;
+  default:
+    break;
+  }
+
+  return false;
+}
+
+void FUNUpdateReplay::EndFrame()
+{
+  // A replay may run faster than the world ticks, so do what the end of a recorded frame did by hand.
+  if (UUNCollectionSubsystem* Subsystem = UUNCollectionSubsystem::Get(World.Get()))
+    Subsystem->FlushPendingUpdates();
+
+  UUNInterpContainer::FlushDeferredBroadcasts();
+}
+
+UMaterialParameterCollectionInstance* FUNUpdateReplay::ResolveCollectionInstance(int32 Index)
+{
+  if (ResolvedTargetMask[Index])
+    return Cast<UMaterialParameterCollectionInstance>(ResolvedTargets[Index].Get());
+
+  ResolvedTargetMask[Index] = true;
+
+  UWorld* WorldPtr = World.Get();
+  UMaterialParameterCollection* Collection = LoadObject<UMaterialParameterCollection>(nullptr, *Names[Index]);
+  if (!WorldPtr || !Collection)
+  {
+    UE_LOG(LogSlate, Warning, TEXT("[%s] Unable to load recorded collection! Collection: [%s]"), *FString(__FUNCTION__), *Names[Index]);
+    return nullptr;
+  }
+
+  // A headless world has no instances of its own, so give it the ones the recording needs.
+  UMaterialParameterCollectionInstance* Instance = WorldPtr->GetParameterCollectionInstance(Collection);
+  if (!Instance)
+  {
+    WorldPtr->AddParameterCollectionInstance(Collection, true);
+    Instance = WorldPtr->GetParameterCollectionInstance(Collection);
+  }
+
+  ResolvedTargets[Index] = Instance;
+  return Instance;
+}
+
+UObject* FUNUpdateReplay::ResolveWidget(int32 Index)
+{
+  if (ResolvedTargetMask[Index])
+    return ResolvedTargets[Index].Get();
+
+  ResolvedTargetMask[Index] = true;
+
+  UObject* Widget = WidgetResolver ? WidgetResolver(Names[Index]) : nullptr;
+  if (!Widget)
+    UE_LOG(LogSlate, Verbose, TEXT("[%s] Recorded widget not found, so its updates are skipped. Widget: [%s]"), *FString(__FUNCTION__), *Names[Index]);
+
+  ResolvedTargets[Index] = Widget;
+  return Widget;
+}
+
+void FUNUpdateReplay::ResetTargets(UWorld* InWorld)
+{
+  World = InWorld;
+  ResolvedTargets.Reset();
+  ResolvedTargets.SetNum(Names.Num());
+  ResolvedTargetMask.Init(false, Names.Num());
+}
+
+bool FUNUpdateReplay::Tick(float DeltaTime)
+{
+  if (!World.IsValid())
+  {
+    TickerHandle.Reset();
+    return false;
+  }
+
+  const double Elapsed = FPlatformTime::Seconds() - PlaybackStartTime;
+
+  for (; NextUpdate < Updates.Num() && Updates[NextUpdate].Time <= Elapsed; ++NextUpdate)
+  {
+    const FUNRecordedUpdate& Update = Updates[NextUpdate];
+    if (Update.Type == EUNRecordedUpdateType::Frame)
+      EndFrame();
+    else
+      ApplyUpdate(Update);
+  }
+
+  if (NextUpdate < Updates.Num())
+    return true;
+
+  EndFrame();
+  TickerHandle.Reset();
+  return false;
+}
\ No newline at end of file
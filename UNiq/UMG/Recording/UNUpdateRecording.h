@@ -0,0 +1,438 @@
+﻿// "Copyright (C) Craig Williams, SlashParadox"
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Ticker.h"
+#include "Serialization/MemoryWriter.h"
+#include "UObject/ObjectKey.h"
+#include "UObject/WeakObjectPtr.h"
+
+class UMaterialParameterCollectionInstance;
+class UWorld;
+
+/**
+ * @enum EUNRecordedUpdateType
+ * @brief The kind of a single recorded update. Serialized as a byte, so only ever append to this.
+ */
+enum class EUNRecordedUpdateType : uint8
+{
+  // The end of a frame with at least one update in it.
+  Frame,
+
+  // A vector parameter of a collection instance was set.
+  CollectionVector,
+
+  // A scalar parameter of a collection instance was set.
+  CollectionScalar,
+
+  // A UUNImage's CollectionLerpAlpha was set.
+  ImageLerpAlpha,
+
+  // A UUNInterpContainer's FloatValue changed.
+  InterpFloat,
+
+  // A UUNInterpContainer's Vector2DValue changed.
+  InterpVector2D,
+
+  // A UUNInterpContainer's ColorValue changed.
+  InterpColor,
+
+  Count
+};
+
+/**
+ * @struct FUNRecordedUpdate
+ * @brief A single update in a recording.
+ */
+struct FUNRecordedUpdate
+{
+  FUNRecordedUpdate()
+    : Time(0.0)
+    , Type(EUNRecordedUpdateType::Frame)
+    , TargetIndex(INDEX_NONE)
+    , ParameterIndex(INDEX_NONE)
+    , Value(ForceInitToZero)
+  {
+  }
+
+  // The time of the update, in seconds since recording started.
+  double Time;
+
+  // The kind of update.
+  EUNRecordedUpdateType Type;
+
+  // The recording's name index of the collection or widget path that was updated.
+  int32 TargetIndex;
+
+  // The recording's name index of the collection parameter that was updated. INDEX_NONE for widgets.
+  int32 ParameterIndex;
+
+  // The new value. Scalars are in R, and 2D vectors are in R and G.
+  FLinearColor Value;
+};
+
+/**
+ * @class FUNUpdateRecorder
+ * @brief Records every collection parameter update in a world, and every UUNImage and UUNInterpContainer value
+ * change, into a compact binary file. Paths and names are written once and referenced by index after, and times
+ * are packed deltas in microseconds. The recording is kept in memory until it is stopped, so recording never
+ * touches the disk mid-frame. Only one recording can run at a time. Game thread only.
+ * Use UN.Recording.Start and UN.Recording.Stop, and replay with FUNUpdateReplay.
+ */
+class UNIQ_API FUNUpdateRecorder
+{
+public:
+  FUNUpdateRecorder(const FUNUpdateRecorder&) = delete;
+  FUNUpdateRecorder& operator=(const FUNUpdateRecorder&) = delete;
+  ~FUNUpdateRecorder();
+
+  /**
+   * Starts recording a world. Collection instances added to the world after this are not recorded, and neither
+   * are widgets in any other world. The recording is stopped and written when the world is cleaned up.
+   * @param World The world to record the collection instances of.
+   * @param Path The file to write the recording to once it is stopped.
+   * @returns Returns true if recording started. False if the world is invalid, or a recording is already running.
+   */
+  static bool Start(UWorld* World, const FString& Path);
+
+  /**
+   * Stops the running recording, and writes it to its file.
+   * @returns Returns true if the recording was written.
+   */
+  static bool Stop();
+
+  /**
+   * Gets the running recording. Check this before recording anything, so nothing is done while not recording.
+   * @returns Returns the active recorder, or null if nothing is being recorded.
+   */
+  static FUNUpdateRecorder* GetActive();
+
+  /**
+   * Records a UUNImage's CollectionLerpAlpha being set.
+   * @param Image The image.
+   * @param Alpha The new lerp alpha.
+   */
+  void RecordImageLerpAlpha(const UObject* Image, float Alpha);
+
+  /**
+   * Records a UUNInterpContainer's FloatValue changing.
+   * @param Container The container.
+   * @param Value The new value.
+   */
+  void RecordInterpFloat(const UObject* Container, float Value);
+
+  /**
+   * Records a UUNInterpContainer's Vector2DValue changing.
+   * @param Container The container.
+   * @param Value The new value.
+   */
+  void RecordInterpVector2D(const UObject* Container, const FVector2D& Value);
+
+  /**
+   * Records a UUNInterpContainer's ColorValue changing.
+   * @param Container The container.
+   * @param Value The new value.
+   */
+  void RecordInterpColor(const UObject* Container, const FLinearColor& Value);
+
+private:
+  /**
+   * @struct FInstanceBinding
+   * @brief The recorder's binding to a single collection instance.
+   */
+  struct FInstanceBinding
+  {
+    // The bound collection instance.
+    TWeakObjectPtr<UMaterialParameterCollectionInstance> Instance;
+
+    // A handle to the delegate bound to the Instance's vector updates.
+    FDelegateHandle VectorDelegateHandle;
+
+    // A handle to the delegate bound to the Instance's scalar updates.
+    FDelegateHandle ScalarDelegateHandle;
+
+    // The path of the Instance's collection.
+    FString CollectionPath;
+
+    // The name index of the CollectionPath, or INDEX_NONE until it is first written.
+    int32 CollectionIndex = INDEX_NONE;
+  };
+
+  /**
+   * Creates a recorder. Use Start instead.
+   * @param InPath The file to write the recording to.
+   */
+  explicit FUNUpdateRecorder(const FString& InPath);
+
+  /**
+   * Binds to the updates of every collection instance in a world.
+   * @param World The world to bind to.
+   */
+  void BindInstances(UWorld* World);
+
+  /** Unbinds from every collection instance.*/
+  void UnbindInstances();
+
+  /**
+   * Checks if a widget is in the recorded world. The recorder is global, so widgets in other worlds still call it.
+   * @param Widget The widget to check.
+   * @returns Returns true if the widget's updates should be recorded.
+   */
+  bool IsInRecordedWorld(const UObject* Widget) const;
+
+  /**
+   * A delegate called upon any world being cleaned up. Stops the recording if it is the recorded world.
+   * @param World The world being cleaned up.
+   * @param bSessionEnded If true, the session has ended.
+   * @param bCleanupResources If true, the world's resources are being cleaned up.
+   */
+  static void OnWorldCleanup(UWorld* World, bool bSessionEnded, bool bCleanupResources);
+
+  /**
+   * A delegate called upon a recorded collection instance updating a vector value.
+   * @param ParameterUpdate The parameter in the collection that was updated.
+   * @param BindingIndex The index of the instance's binding.
+   */
+  void OnVectorParameterUpdated(TPair<FName, FLinearColor> ParameterUpdate, int32 BindingIndex);
+
+  /**
+   * A delegate called upon a recorded collection instance updating a scalar value.
+   * @param ParameterUpdate The parameter in the collection that was updated.
+   * @param BindingIndex The index of the instance's binding.
+   */
+  void OnScalarParameterUpdated(TPair<FName, float> ParameterUpdate, int32 BindingIndex);
+
+  /** A delegate called at the end of every frame. Marks the end of any frame with updates.*/
+  void OnEndFrame();
+
+  /**
+   * Writes the type and time of a new update.
+   * @param Type The type of the update.
+   */
+  void WriteUpdateHeader(EUNRecordedUpdateType Type);
+
+  /**
+   * Writes a reference to a name. The name itself is only written the first time.
+   * @param Name The name.
+   * @returns Returns the name's index. Write it with WriteNameIndex from then on, to skip the lookup.
+   */
+  int32 WriteName(const FString& Name);
+
+  /**
+   * Writes a reference to a name that was already written.
+   * @param Index The name's index, from WriteName.
+   */
+  void WriteNameIndex(int32 Index);
+
+  /**
+   * Writes a reference to a collection instance's collection path.
+   * @param Binding The binding of the collection instance.
+   */
+  void WriteCollectionName(FInstanceBinding& Binding);
+
+  /**
+   * Writes a reference to a widget's path name.
+   * @param Widget The widget.
+   */
+  void WriteWidgetName(const UObject* Widget);
+
+  /**
+   * Writes a reference to a collection parameter's name.
+   * @param ParameterName The name of the parameter.
+   */
+  void WriteParameterName(const FName& ParameterName);
+
+  /**
+   * Writes a color as four floats.
+   * @param Color The color to write.
+   */
+  void WriteColor(FLinearColor Color);
+
+private:
+  // The file the recording is written to once stopped.
+  FString Path;
+
+  // The recording so far.
+  TArray<uint8> Data;
+
+  // The writer into the Data.
+  FMemoryWriter Writer;
+
+  // The index of every name written so far.
+  TMap<FString, int32> NameIndices;
+
+  // The name index of every parameter written so far, to skip converting it to a string.
+  TMap<FName, int32> ParameterNameIndices;
+
+  // The name index of every widget written so far, to skip building its path.
+  TMap<TObjectKey<UObject>, int32> WidgetNameIndices;
+
+  // The world being recorded.
+  TObjectKey<UWorld> RecordedWorld;
+
+  // The binding to each collection instance of the recorded world.
+  TArray<FInstanceBinding> InstanceBindings;
+
+  // The handle to FCoreDelegates::OnEndFrame.
+  FDelegateHandle EndFrameHandle;
+
+  // The handle to FWorldDelegates::OnWorldCleanup.
+  FDelegateHandle WorldCleanupHandle;
+
+  // The time recording started, in seconds.
+  double StartTime;
+
+  // The time of the last update, in microseconds since recording started.
+  uint64 LastUpdateMicroseconds;
+
+  // If true, at least one update was recorded since the last frame ended.
+  bool bUpdatedThisFrame;
+};
+
+/**
+ * @class FUNUpdateReplay
+ * @brief Replays a recording made by FUNUpdateRecorder into a world. Collections are loaded by path, and added to
+ * the world if it has no instance of them, so a bare headless world works. Widgets are found by path by default.
+ * Set a widget resolver to stand in widgets of your own. Each recorded frame is flushed through the
+ * UUNCollectionSubsystem and UUNInterpContainer deferred broadcasts, so a replay applies the same batches in the
+ * same order no matter how fast it runs. Use UN.Recording.Replay.
+ */
+class UNIQ_API FUNUpdateReplay
+{
+public:
+  FUNUpdateReplay();
+  ~FUNUpdateReplay();
+
+  /**
+   * Loads a recording, replacing any loaded before. Any running replay is stopped.
+   * @param Path The file to load.
+   * @returns Returns true if the whole file was read.
+   */
+  bool Load(const FString& Path);
+
+  /**
+   * Sets the function used to find the widget of a recorded path.
+   * @param InWidgetResolver The resolver. Returns the widget to update, or null to skip it.
+   */
+  void SetWidgetResolver(TFunction<UObject*(const FString&)> InWidgetResolver) { WidgetResolver = MoveTemp(InWidgetResolver); }
+
+  /**
+   * Replays the whole recording right away, as fast as possible.
+   * @param World The world to replay into.
+   * @returns Returns the number of updates that were applied. Updates with a missing target are skipped.
+   */
+  int32 ReplayAll(UWorld* World);
+
+  /**
+   * Starts replaying the recording in real time, with updates applied on the frame their recorded time passes.
+   * @param World The world to replay into.
+   * @returns Returns true if the replay started.
+   */
+  bool StartRealTime(UWorld* World);
+
+  /** Stops a real time replay.*/
+  void Stop();
+
+  /**
+   * Checks if a real time replay is running.
+   * @returns Returns true if the replay is running.
+   */
+  bool IsPlaying() const { return TickerHandle.IsValid(); }
+
+  /**
+   * Gets every update in the loaded recording, including frame markers.
+   * @returns Returns the updates, in order.
+   */
+  const TArray<FUNRecordedUpdate>& GetUpdates() const { return Updates; }
+
+  /**
+   * Gets every collection path, parameter name, and widget path in the loaded recording.
+   * @returns Returns the names, indexed by the TargetIndex and ParameterIndex of the updates.
+   */
+  const TArray<FString>& GetNames() const { return Names; }
+
+  /**
+   * Gets the number of recorded frames with updates.
+   * @returns Returns the number of frames.
+   */
+  int32 GetNumFrames() const { return NumFrames; }
+
+  /**
+   * Gets the length of the recording.
+   * @returns Returns the time of the last update, in seconds.
+   */
+  double GetDuration() const { return Updates.IsEmpty() ? 0.0 : Updates.Last().Time; }
+
+private:
+  /**
+   * Applies a single update, resolving its target if this is the first use of it.
+   * @param Update The update to apply.
+   * @returns Returns true if the update was applied.
+   */
+  bool ApplyUpdate(const FUNRecordedUpdate& Update);
+
+  /** Flushes everything the updates of the frame queued, so each frame is applied as one batch.*/
+  void EndFrame();
+
+  /**
+   * Resolves the collection instance of a recorded collection path, adding it to the world if needed.
+   * @param Index The name index of the path.
+   * @returns Returns the collection instance, if the collection could be loaded.
+   */
+  UMaterialParameterCollectionInstance* ResolveCollectionInstance(int32 Index);
+
+  /**
+   * Resolves the widget of a recorded path, through the widget resolver.
+   * @param Index The name index of the path.
+   * @returns Returns the widget, if found.
+   */
+  UObject* ResolveWidget(int32 Index);
+
+  /**
+   * Clears every resolved target, and binds the replay to a world.
+   * @param InWorld The world to replay into.
+   */
+  void ResetTargets(UWorld* InWorld);
+
+  /**
+   * Ticks a real time replay.
+   * @param DeltaTime The time since the last tick.
+   * @returns Returns true while there are updates left to replay.
+   */
+  bool Tick(float DeltaTime);
+
+private:
+  // Every name in the recording, by index.
+  TArray<FString> Names;
+
+  // Every name in the recording as an FName, for parameter lookups.
+  TArray<FName> ParameterNames;
+
+  // Every update in the recording, in order.
+  TArray<FUNRecordedUpdate> Updates;
+
+  // The number of frame markers in the Updates.
+  int32 NumFrames;
+
+  // The resolved target of each name index. Only valid where the matching bit in ResolvedTargetMask is set.
+  TArray<TWeakObjectPtr<UObject>> ResolvedTargets;
+
+  // Which name indices have been resolved, successfully or not.
+  TBitArray<> ResolvedTargetMask;
+
+  // Finds the widget of a recorded path.
+  TFunction<UObject*(const FString&)> WidgetResolver;
+
+  // The world being replayed into.
+  TWeakObjectPtr<UWorld> World;
+
+  // The index of the next update to apply in a real time replay.
+  int32 NextUpdate;
+
+  // The time the real time replay started, in seconds.
+  double PlaybackStartTime;
+
+  // The handle to the real time replay's ticker.
+  FTSTicker::FDelegateHandle TickerHandle;
+};
\ No newline at end of file
@@ -0,0 +1,308 @@
+﻿// "Copyright (C) Craig Williams, SlashParadox"
+
+#include "UNCollectionColorPool.h"
+
+#include "SlateGlobals.h"
+
+FUNCollectionColorPool::FUNCollectionColorPool()
+  : bHasDirtyBlocks(false)
+{
+}
+
+int32 FUNCollectionColorPool::Add(const FUNCollectionColorPoolKey& Key, UObject* Owner, FUNCollectionListener* Listener, const FLinearColor& Primary, const FLinearColor& Secondary, const FLinearColor& Result)
+{
+  // Another listener already has the same inputs, so the entry is shared instead of evaluated twice.
+  if (const int32* ExistingIndex = EntryIndices.Find(Key))
+  {
+    Listeners[*ExistingIndex].Emplace(Owner, Listener);
+    return *ExistingIndex;
+  }
+
+  int32 Index = INDEX_NONE;
+
+  if (!FreeIndices.IsEmpty())
+  {
+    Index = FreeIndices.Pop(false);
+  }
+  else
+  {
+    Index = Listeners.AddDefaulted();
+    Keys.AddDefaulted();
+
+    // Grow a whole block at a time, so every block can be loaded straight into a register.
+    if (Index % BlockSize == 0)
+    {
+      for (TArray<float>& Channel : Channels)
+      {
+        Channel.AddZeroed(BlockSize);
+      }
+
+      DirtyBlocks.Add(false);
+    }
+  }
+
+  Keys[Index] = Key;
+  Listeners[Index].Emplace(Owner, Listener);
+  EntryIndices.Add(Key, Index);
+
+  if (Key.PrimaryHandle != INDEX_NONE)
+    EntriesByParameter.FindOrAdd(Key.PrimaryHandle).Add(Index);
+
+  if (Key.SecondaryHandle != INDEX_NONE && Key.SecondaryHandle != Key.PrimaryHandle)
+    EntriesByParameter.FindOrAdd(Key.SecondaryHandle).Add(Index);
+
+  SetColorChannels(Index, PrimaryR, Primary);
+  SetColorChannels(Index, SecondaryR, Secondary);
+  Channels[EChannel::LerpAlpha][Index] = Key.LerpAlpha;
+  SetColorChannels(Index, ResultR, Result);
+  return Index;
+}
+
+void FUNCollectionColorPool::Remove(int32 Index, const FUNCollectionListener* Listener)
+{
+  if (!Listeners.IsValidIndex(Index))
+    return;
+
+  TArray<FUNCollectionColorPoolListener>& EntryListeners = Listeners[Index];
+  const int32 ListenerIndex = EntryListeners.IndexOfByPredicate([Listener](const FUNCollectionColorPoolListener& PoolListener)
+  {
+    return PoolListener.Listener == Listener;
+  });
+
+  if (ListenerIndex == INDEX_NONE)
+    return;
+
+  EntryListeners.RemoveAtSwap(ListenerIndex, 1, false);
+  if (!EntryListeners.IsEmpty())
+    return;
+
+  // The last listener left, so nothing can ever be told about this entry again.
+  const FUNCollectionColorPoolKey& Key = Keys[Index];
+  EntryIndices.Remove(Key);
+
+  for (const int32 ParameterHandle : { Key.PrimaryHandle, Key.SecondaryHandle })
+  {
+    TArray<int32>* Entries = EntriesByParameter.Find(ParameterHandle);
+    if (!Entries)
+      continue;
+
+    Entries->RemoveSingleSwap(Index, false);
+    if (Entries->IsEmpty())
+      EntriesByParameter.Remove(ParameterHandle);
+  }
+
+  Keys[Index] = FUNCollectionColorPoolKey();
+  FreeIndices.Add(Index);
+}
+
+void FUNCollectionColorPool::RemoveStaleListeners(int32 ParameterHandle)
+{
+  const TArray<int32>* Entries = EntriesByParameter.Find(ParameterHandle);
+  if (!Entries)
+    return;
+
+  // Removing the last listener of an entry removes it from the lookup being walked.
+  const TArray<int32> EntriesCopy = *Entries;
+  for (const int32 Index : EntriesCopy)
+  {
+    // The listeners are only compared, never used, so a destroyed owner's listener is safe to pass along.
+    TArray<const FUNCollectionListener*> StaleListeners;
+    for (const FUNCollectionColorPoolListener& PoolListener : Listeners[Index])
+    {
+      if (!PoolListener.Owner.IsValid())
+        StaleListeners.Add(PoolListener.Listener);
+    }
+
+    for (const FUNCollectionListener* Listener : StaleListeners)
+      Remove(Index, Listener);
+  }
+}
+
+void FUNCollectionColorPool::Empty()
+{
+  for (TArray<float>& Channel : Channels)
+  {
+    Channel.Empty();
+  }
+
+  Keys.Empty();
+  Listeners.Empty();
+  FreeIndices.Empty();
+  EntryIndices.Empty();
+  EntriesByParameter.Empty();
+  DirtyBlocks.Empty();
+  bHasDirtyBlocks = false;
+}
+
+void FUNCollectionColorPool::SetParameterColor(int32 ParameterHandle, const FLinearColor& Color)
+{
+  const TArray<int32>* Entries = EntriesByParameter.Find(ParameterHandle);
+  if (!Entries)
+    return;
+
+  for (const int32 Index : *Entries)
+  {
+    const FUNCollectionColorPoolKey& Key = Keys[Index];
+
+    if (Key.PrimaryHandle == ParameterHandle)
+      SetColorChannels(Index, PrimaryR, Color);
+
+    if (Key.SecondaryHandle == ParameterHandle)
+      SetColorChannels(Index, SecondaryR, Color);
+
+    MarkDirty(Index);
+  }
+}
+
+void FUNCollectionColorPool::Evaluate(TArray<int32>& OutChangedIndices, bool bVectorized, bool bVerify)
+{
+  if (!bHasDirtyBlocks)
+    return;
+
+  for (TConstSetBitIterator<> It(DirtyBlocks); It; ++It)
+  {
+    const int32 Offset = It.GetIndex() * BlockSize;
+
+    if (bVerify)
+      VerifyBlock(Offset);
+
+    const uint32 ChangedLanes = bVectorized ? EvaluateBlockVectorized(Offset) : EvaluateBlockScalar(Offset);
+    if (ChangedLanes == 0)
+      continue;
+
+    for (int32 Lane = 0; Lane < BlockSize; ++Lane)
+    {
+      const int32 Index = Offset + Lane;
+
+      // Padding and removed entries are evaluated too, but nobody is told about them.
+      if ((ChangedLanes & (1u << Lane)) != 0 && Listeners.IsValidIndex(Index) && !Listeners[Index].IsEmpty())
+        OutChangedIndices.Add(Index);
+    }
+  }
+
+  DirtyBlocks.SetRange(0, DirtyBlocks.Num(), false);
+  bHasDirtyBlocks = false;
+}
+
+SIZE_T FUNCollectionColorPool::GetAllocatedSize() const
+{
+  SIZE_T Size = Keys.GetAllocatedSize() + Listeners.GetAllocatedSize() + FreeIndices.GetAllocatedSize() + EntryIndices.GetAllocatedSize()
+    + EntriesByParameter.GetAllocatedSize() + DirtyBlocks.GetAllocatedSize();
+
+  for (const TArray<float>& Channel : Channels)
+  {
+    Size += Channel.GetAllocatedSize();
+  }
+
+  for (const TArray<FUNCollectionColorPoolListener>& EntryListeners : Listeners)
+  {
+    Size += EntryListeners.GetAllocatedSize();
+  }
+
+  for (const TPair<int32, TArray<int32>>& ParameterEntries : EntriesByParameter)
+  {
+    Size += ParameterEntries.Value.GetAllocatedSize();
+  }
+
+  return Size;
+}
+
+FLinearColor FUNCollectionColorPool::GetResult(int32 Index) const
+{
+  return FLinearColor(Channels[ResultR][Index], Channels[ResultG][Index], Channels[ResultB][Index], Channels[ResultA][Index]);
+}
+
+uint32 FUNCollectionColorPool::EvaluateBlockVectorized(int32 Offset)
+{
+  VectorRegister4Float ChangedMask = VectorZero();
+
+  for (int32 Channel = 0; Channel < 4; ++Channel)
+  {
+    float* ResultData = &Channels[ResultR + Channel][Offset];
+
+    const VectorRegister4Float Result = LerpChannelVectorized(Offset, Channel);
+    ChangedMask = VectorBitwiseOr(ChangedMask, VectorCompareNE(Result, VectorLoad(ResultData)));
+    VectorStore(Result, ResultData);
+  }
+
+  return static_cast<uint32>(VectorMaskBits(ChangedMask));
+}
+
+uint32 FUNCollectionColorPool::EvaluateBlockScalar(int32 Offset)
+{
+  uint32 ChangedLanes = 0;
+
+  for (int32 Lane = 0; Lane < BlockSize; ++Lane)
+  {
+    const int32 Index = Offset + Lane;
+    const float Alpha = Channels[EChannel::LerpAlpha][Index];
+
+    for (int32 Channel = 0; Channel < 4; ++Channel)
+    {
+      float& StoredResult = Channels[ResultR + Channel][Index];
+
+      const float Result = LerpChannelScalar(Channels[PrimaryR + Channel][Index], Channels[SecondaryR + Channel][Index], Alpha);
+      if (Result != StoredResult)
+        ChangedLanes |= 1u << Lane;
+
+      StoredResult = Result;
+    }
+  }
+
+  return ChangedLanes;
+}
+
+void FUNCollectionColorPool::VerifyBlock(int32 Offset) const
+{
+  for (int32 Channel = 0; Channel < 4; ++Channel)
+  {
+    float VectorizedResults[BlockSize];
+    VectorStore(LerpChannelVectorized(Offset, Channel), VectorizedResults);
+
+    for (int32 Lane = 0; Lane < BlockSize; ++Lane)
+    {
+      const int32 Index = Offset + Lane;
+      const float ScalarResult = LerpChannelScalar(Channels[PrimaryR + Channel][Index], Channels[SecondaryR + Channel][Index], Channels[EChannel::LerpAlpha][Index]);
+
+      // Compare the bits, so that matching NaNs count as identical.
+      if (FMemory::Memcmp(&ScalarResult, &VectorizedResults[Lane], sizeof(float)) != 0)
+      {
+        const UObject* Owner = Listeners.IsValidIndex(Index) && !Listeners[Index].IsEmpty() ? Listeners[Index][0].Owner.Get() : nullptr;
+        UE_LOG(LogSlate, Error, TEXT("[%s] Vectorized and scalar results differ! Entry: [%d] Owner: [%s] Channel: [%d] Vectorized: [%.9g] Scalar: [%.9g]"),
+          *FString(__FUNCTION__), Index, *GetNameSafe(Owner), Channel, VectorizedResults[Lane], ScalarResult);
+      }
+    }
+  }
+}
+
+VectorRegister4Float FUNCollectionColorPool::LerpChannelVectorized(int32 Offset, int32 Channel) const
+{
+  const VectorRegister4Float Primary = VectorLoad(&Channels[PrimaryR + Channel][Offset]);
+  const VectorRegister4Float Secondary = VectorLoad(&Channels[SecondaryR + Channel][Offset]);
+  const VectorRegister4Float Alpha = VectorLoad(&Channels[EChannel::LerpAlpha][Offset]);
+
+  // Not a fused multiply-add, so the rounding matches the scalar fallback and UUNImage exactly.
+  return VectorAdd(Primary, VectorMultiply(Alpha, VectorSubtract(Secondary, Primary)));
+}
+
+float FUNCollectionColorPool::LerpChannelScalar(float Primary, float Secondary, float Alpha)
+{
+  // Each step is its own statement, so the compiler can't contract them into a fused multiply-add.
+  const float Delta = Secondary - Primary;
+  const float Scaled = Alpha * Delta;
+  return Primary + Scaled;
+}
+
+void FUNCollectionColorPool::MarkDirty(int32 Index)
+{
+  DirtyBlocks[Index / BlockSize] = true;
+  bHasDirtyBlocks = true;
+}
+
+void FUNCollectionColorPool::SetColorChannels(int32 Index, int32 FirstChannel, const FLinearColor& Color)
+{
+  Channels[FirstChannel][Index] = Color.R;
+  Channels[FirstChannel + 1][Index] = Color.G;
+  Channels[FirstChannel + 2][Index] = Color.B;
+  Channels[FirstChannel + 3][Index] = Color.A;
+}
\ No newline at end of file
@@ -0,0 +1,300 @@
+﻿// "Copyright (C) Craig Williams, SlashParadox"
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/WeakObjectPtr.h"
+
+class FUNCollectionListener;
+
+/**
+ * @struct FUNCollectionColorPoolKey
+ * @brief The inputs of a pooled collection color. Listeners with equal keys always evaluate to the same color,
+ * so they share a single entry.
+ */
+struct FUNCollectionColorPoolKey
+{
+  FUNCollectionColorPoolKey()
+    : PrimaryHandle(INDEX_NONE)
+    , SecondaryHandle(INDEX_NONE)
+    , PrimaryConstant(ForceInitToZero)
+    , SecondaryConstant(ForceInitToZero)
+    , LerpAlpha(0.0f)
+  {
+  }
+
+  FUNCollectionColorPoolKey(int32 InPrimaryHandle, int32 InSecondaryHandle, const FLinearColor& Primary, const FLinearColor& Secondary, float InLerpAlpha)
+    : PrimaryHandle(InPrimaryHandle)
+    , SecondaryHandle(InSecondaryHandle)
+    , PrimaryConstant(InPrimaryHandle == INDEX_NONE ? Primary : FLinearColor(ForceInitToZero))
+    , SecondaryConstant(InSecondaryHandle == INDEX_NONE ? Secondary : FLinearColor(ForceInitToZero))
+    , LerpAlpha(InLerpAlpha)
+  {
+  }
+
+  // The parameter table handle of the primary color, or INDEX_NONE if the color is constant.
+  int32 PrimaryHandle;
+
+  // The parameter table handle of the secondary color, or INDEX_NONE if the color is constant.
+  int32 SecondaryHandle;
+
+  // The primary color, if it is not bound to a parameter. Zero otherwise.
+  FLinearColor PrimaryConstant;
+
+  // The secondary color, if it is not bound to a parameter. Zero otherwise.
+  FLinearColor SecondaryConstant;
+
+  // The linear interpolation alpha between the colors.
+  float LerpAlpha;
+
+  // Colors are compared bit for bit, so that hashing stays consistent for signed zeros and NaNs.
+  FORCEINLINE bool operator==(const FUNCollectionColorPoolKey& Other) const
+  {
+    return PrimaryHandle == Other.PrimaryHandle && SecondaryHandle == Other.SecondaryHandle
+      && FMemory::Memcmp(&PrimaryConstant, &Other.PrimaryConstant, sizeof(FLinearColor)) == 0
+      && FMemory::Memcmp(&SecondaryConstant, &Other.SecondaryConstant, sizeof(FLinearColor)) == 0
+      && FMemory::Memcmp(&LerpAlpha, &Other.LerpAlpha, sizeof(float)) == 0;
+  }
+
+  FORCEINLINE friend uint32 GetTypeHash(const FUNCollectionColorPoolKey& Key)
+  {
+    uint32 Hash = HashCombine(GetTypeHash(Key.PrimaryHandle), GetTypeHash(Key.SecondaryHandle));
+    Hash = FCrc::MemCrc32(&Key.PrimaryConstant, sizeof(FLinearColor), Hash);
+    Hash = FCrc::MemCrc32(&Key.SecondaryConstant, sizeof(FLinearColor), Hash);
+    return FCrc::MemCrc32(&Key.LerpAlpha, sizeof(float), Hash);
+  }
+};
+
+/**
+ * @struct FUNCollectionColorPoolListener
+ * @brief A single listener sharing a pooled collection color.
+ */
+struct FUNCollectionColorPoolListener
+{
+  FUNCollectionColorPoolListener()
+    : Listener(nullptr)
+  {
+  }
+
+  FUNCollectionColorPoolListener(UObject* InOwner, FUNCollectionListener* InListener)
+    : Owner(InOwner)
+    , Listener(InListener)
+  {
+  }
+
+  // The object that owns the Listener. The Listener is only valid while this is.
+  TWeakObjectPtr<UObject> Owner;
+
+  // The listener to tell when the evaluated color changes.
+  FUNCollectionListener* Listener;
+};
+
+/**
+ * @class FUNCollectionColorPool
+ * @brief A structure-of-arrays pool of collection colors. Each entry holds a primary and secondary color and the
+ * lerp alpha between them. Entries are interned by their inputs, so any number of listeners bound to the same
+ * colors at the same alpha share one entry, and it is evaluated once for all of them. Entries are evaluated in
+ * blocks of four, one vector register per color channel, and only blocks with updated inputs are evaluated at
+ * all. A scalar fallback produces bit-identical results.
+ */
+class UNIQ_API FUNCollectionColorPool
+{
+public:
+  FUNCollectionColorPool();
+
+  /**
+   * Adds a listener to the entry of a key, adding the entry if no other listener shares it yet.
+   * @param Key The inputs of the listener's color.
+   * @param Owner The object that owns the Listener.
+   * @param Listener The listener to tell when the entry's evaluated color changes.
+   * @param Primary The current primary color.
+   * @param Secondary The current secondary color.
+   * @param Result The color the listener is currently displaying.
+   * @returns Returns the index of the entry.
+   */
+  int32 Add(const FUNCollectionColorPoolKey& Key, UObject* Owner, FUNCollectionListener* Listener, const FLinearColor& Primary, const FLinearColor& Secondary, const FLinearColor& Result);
+
+  /**
+   * Removes a listener from an entry. Once an entry has no listeners, its index may be reused by the next added entry.
+   * @param Index The index of the entry.
+   * @param Listener The listener to remove.
+   */
+  void Remove(int32 Index, const FUNCollectionListener* Listener);
+
+  /**
+   * Removes every listener whose owner was destroyed from the entries that use a parameter.
+   * @param ParameterHandle The parameter table handle of the parameter.
+   */
+  void RemoveStaleListeners(int32 ParameterHandle);
+
+  /** Removes every entry from the pool.*/
+  void Empty();
+
+  /**
+   * Sets a parameter's color in every entry that uses it, and marks them for evaluation.
+   * @param ParameterHandle The parameter table handle of the parameter.
+   * @param Color The new color.
+   */
+  void SetParameterColor(int32 ParameterHandle, const FLinearColor& Color);
+
+  /**
+   * Checks if a subscription slot is one of the two colors evaluated by the pool.
+   * @param Slot The slot to check.
+   * @returns Returns true for the primary slot, 0, and the secondary slot, 1.
+   */
+  static bool IsPooledSlot(int32 Slot) { return Slot == 0 || Slot == 1; }
+
+  /**
+   * Evaluates every entry marked since the last evaluation.
+   * @param OutChangedIndices The indices of each entry whose evaluated color changed.
+   * @param bVectorized If true, entries are evaluated with vector registers. Otherwise, the scalar fallback is used.
+   * @param bVerify If true, both paths are run and any entry they disagree on is logged.
+   */
+  void Evaluate(TArray<int32>& OutChangedIndices, bool bVectorized, bool bVerify = false);
+
+  /**
+   * Gets the last evaluated color of an entry.
+   * @param Index The index of the entry.
+   * @returns Returns the evaluated color.
+   */
+  FLinearColor GetResult(int32 Index) const;
+
+  /**
+   * Gets the key of an entry.
+   * @param Index The index of the entry.
+   * @returns Returns the key. Only meaningful while the entry has listeners.
+   */
+  const FUNCollectionColorPoolKey& GetKey(int32 Index) const { return Keys[Index]; }
+
+  /**
+   * Gets the listeners sharing an entry.
+   * @param Index The index of the entry.
+   * @returns Returns the listeners. Empty for removed entries.
+   */
+  const TArray<FUNCollectionColorPoolListener>& GetListeners(int32 Index) const { return Listeners[Index]; }
+
+  /**
+   * Gets the number of entry indices, including removed ones waiting to be reused.
+   * @returns Returns the number of entry indices.
+   */
+  int32 Num() const { return Listeners.Num(); }
+
+  /**
+   * Gets the number of entries in use. Each is a distinct pooled color, no matter how many listeners share it.
+   * @returns Returns the number of entries with listeners.
+   */
+  int32 NumEntries() const { return EntryIndices.Num(); }
+
+  /**
+   * Checks if any entry is marked for evaluation.
+   * @returns Returns true if the next Evaluate has work to do.
+   */
+  bool HasDirtyEntries() const { return bHasDirtyBlocks; }
+
+  /**
+   * Gets the heap memory used by the pool.
+   * @returns Returns the allocated size of every entry, listener, and lookup, in bytes.
+   */
+  SIZE_T GetAllocatedSize() const;
+
+private:
+  /**
+   * The per-entry channels of the pool. Each is its own array, so four neighboring entries fill one register.
+   */
+  enum EChannel : int32
+  {
+    PrimaryR,
+    PrimaryG,
+    PrimaryB,
+    PrimaryA,
+    SecondaryR,
+    SecondaryG,
+    SecondaryB,
+    SecondaryA,
+    LerpAlpha,
+    ResultR,
+    ResultG,
+    ResultB,
+    ResultA,
+    NumChannels
+  };
+
+  /**
+   * Evaluates a block of entries with vector registers.
+   * @param Offset The index of the first entry in the block.
+   * @returns Returns a mask of the entries in the block whose evaluated color changed.
+   */
+  uint32 EvaluateBlockVectorized(int32 Offset);
+
+  /**
+   * Evaluates a block of entries one channel at a time.
+   * @param Offset The index of the first entry in the block.
+   * @returns Returns a mask of the entries in the block whose evaluated color changed.
+   */
+  uint32 EvaluateBlockScalar(int32 Offset);
+
+  /**
+   * Checks that both evaluation paths agree on a block of entries, logging any entry they don't.
+   * @param Offset The index of the first entry in the block.
+   */
+  void VerifyBlock(int32 Offset) const;
+
+  /**
+   * Evaluates one channel of a block of entries with vector registers.
+   * @param Offset The index of the first entry in the block.
+   * @param Channel The color channel to evaluate, from 0 to 3.
+   * @returns Returns the evaluated channel of each entry in the block.
+   */
+  VectorRegister4Float LerpChannelVectorized(int32 Offset, int32 Channel) const;
+
+  /**
+   * Evaluates one channel of a single entry.
+   * @param Primary The primary color's channel.
+   * @param Secondary The secondary color's channel.
+   * @param Alpha The linear interpolation alpha.
+   * @returns Returns the evaluated channel.
+   */
+  static float LerpChannelScalar(float Primary, float Secondary, float Alpha);
+
+  /**
+   * Marks an entry's block for the next evaluation.
+   * @param Index The index of the entry.
+   */
+  void MarkDirty(int32 Index);
+
+  /**
+   * Sets the primary or secondary color channels of an entry.
+   * @param Index The index of the entry.
+   * @param FirstChannel The first channel of the color, either PrimaryR or SecondaryR.
+   * @param Color The new color.
+   */
+  void SetColorChannels(int32 Index, int32 FirstChannel, const FLinearColor& Color);
+
+private:
+  // The number of entries evaluated together, one per lane of a vector register.
+  static constexpr int32 BlockSize = 4;
+
+  // Each channel of every entry. Always padded to a whole number of blocks.
+  TArray<float> Channels[NumChannels];
+
+  // The key of each entry.
+  TArray<FUNCollectionColorPoolKey> Keys;
+
+  // The listeners sharing each entry. Empty for removed entries.
+  TArray<TArray<FUNCollectionColorPoolListener>> Listeners;
+
+  // The removed entry indices, waiting to be reused.
+  TArray<int32> FreeIndices;
+
+  // The index of the entry for each key in use.
+  TMap<FUNCollectionColorPoolKey, int32> EntryIndices;
+
+  // The entries that use each parameter, by parameter table handle.
+  TMap<int32, TArray<int32>> EntriesByParameter;
+
+  // The blocks with inputs updated since the last evaluation.
+  TBitArray<> DirtyBlocks;
+
+  // If true, at least one bit in the DirtyBlocks is set.
+  bool bHasDirtyBlocks;
+};
\ No newline at end of file
@@ -0,0 +1,75 @@
+﻿// "Copyright (C) Craig Williams, SlashParadox"
+
+#include "UNCollectionParameterTable.h"
+
+int32 FUNCollectionParameterTable::Acquire(TObjectKey<UMaterialParameterCollectionInstance> InstanceKey, const FName& ParameterName, bool& bOutAdded)
+{
+  const TPair<TObjectKey<UMaterialParameterCollectionInstance>, FName> Key(InstanceKey, ParameterName);
+
+  if (const int32* ExistingHandle = Handles.Find(Key))
+  {
+    bOutAdded = false;
+    ++Entries[*ExistingHandle].RefCount;
+    return *ExistingHandle;
+  }
+
+  const int32 Handle = !FreeHandles.IsEmpty() ? FreeHandles.Pop(false) : Entries.AddDefaulted();
+
+  FEntry& Entry = Entries[Handle];
+  Entry.InstanceKey = InstanceKey;
+  Entry.ParameterName = ParameterName;
+  Entry.Value = FLinearColor::White;
+  Entry.RefCount = 1;
+
+  Handles.Add(Key, Handle);
+  bOutAdded = true;
+  return Handle;
+}
+
+void FUNCollectionParameterTable::Release(int32 Handle)
+{
+  if (!IsValidHandle(Handle))
+    return;
+
+  FEntry& Entry = Entries[Handle];
+  if (--Entry.RefCount > 0)
+    return;
+
+  Handles.Remove(MakeTuple(Entry.InstanceKey, Entry.ParameterName));
+  Entry = FEntry();
+  FreeHandles.Add(Handle);
+}
+
+int32 FUNCollectionParameterTable::Find(TObjectKey<UMaterialParameterCollectionInstance> InstanceKey, const FName& ParameterName) const
+{
+  const int32* Handle = Handles.Find(MakeTuple(InstanceKey, ParameterName));
+  return Handle ? *Handle : INDEX_NONE;
+}
+
+void FUNCollectionParameterTable::Empty()
+{
+  Entries.Empty();
+  FreeHandles.Empty();
+  Handles.Empty();
+}
+
+SIZE_T FUNCollectionParameterTable::GetAllocatedSize() const
+{
+  return Entries.GetAllocatedSize() + FreeHandles.GetAllocatedSize() + Handles.GetAllocatedSize();
+}
+
+SIZE_T FUNCollectionParameterTable::GetUninternedSize() const
+{
+  SIZE_T NumReferences = 0;
+  for (const FEntry& Entry : Entries)
+  {
+    NumReferences += Entry.RefCount;
+  }
+
+  return NumReferences * (sizeof(FEntry::InstanceKey) + sizeof(FEntry::ParameterName) + sizeof(FEntry::Value));
+}
+
+bool FUNCollectionParameterTable::Matches(int32 Handle, TObjectKey<UMaterialParameterCollectionInstance> InstanceKey, const FName& ParameterName) const
+{
+  return IsValidHandle(Handle) && Entries[Handle].InstanceKey == InstanceKey && Entries[Handle].ParameterName == ParameterName;
+}
\ No newline at end of file
@@ -0,0 +1,136 @@
+﻿// "Copyright (C) Craig Williams, SlashParadox"
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/ObjectKey.h"
+
+class UMaterialParameterCollectionInstance;
+
+/**
+ * @class FUNCollectionParameterTable
+ * @brief An interned table of (collection instance, vector parameter) pairs. Each distinct pair is stored once
+ * with its current value, and everything bound to it shares a small handle into the table instead of its own
+ * copy of the path, name, and value. Entries are reference counted, and their handles reused once released.
+ */
+class UNIQ_API FUNCollectionParameterTable
+{
+public:
+  /**
+   * Acquires a reference to the entry of a parameter, adding it if it does not exist yet.
+   * @param InstanceKey The key of the collection instance the parameter is in.
+   * @param ParameterName The name of the vector parameter.
+   * @param bOutAdded Set to true if the entry was just added, and its value still needs to be set.
+   * @returns Returns the handle of the entry.
+   */
+  int32 Acquire(TObjectKey<UMaterialParameterCollectionInstance> InstanceKey, const FName& ParameterName, bool& bOutAdded);
+
+  /**
+   * Releases a reference to an entry. The entry is removed once nothing references it.
+   * @param Handle The handle of the entry.
+   */
+  void Release(int32 Handle);
+
+  /**
+   * Finds the entry of a parameter, without acquiring a reference to it.
+   * @param InstanceKey The key of the collection instance the parameter is in.
+   * @param ParameterName The name of the vector parameter.
+   * @returns Returns the handle of the entry, or INDEX_NONE if nothing is bound to the parameter.
+   */
+  int32 Find(TObjectKey<UMaterialParameterCollectionInstance> InstanceKey, const FName& ParameterName) const;
+
+  /** Removes every entry from the table. Any handles still held become invalid.*/
+  void Empty();
+
+  /**
+   * Checks if a handle refers to an entry in use.
+   * @param Handle The handle to check.
+   * @returns Returns true if the handle is valid.
+   */
+  bool IsValidHandle(int32 Handle) const { return Entries.IsValidIndex(Handle) && Entries[Handle].RefCount > 0; }
+
+  /**
+   * Checks if a handle refers to the entry of exactly a parameter.
+   * @param Handle The handle to check.
+   * @param InstanceKey The key of the collection instance the parameter is in.
+   * @param ParameterName The name of the vector parameter.
+   * @returns Returns true if the handle is valid, and its entry is the parameter's.
+   */
+  bool Matches(int32 Handle, TObjectKey<UMaterialParameterCollectionInstance> InstanceKey, const FName& ParameterName) const;
+
+  /**
+   * Gets the current value of an entry.
+   * @param Handle The handle of the entry. Must be valid.
+   * @returns Returns the value.
+   */
+  const FLinearColor& GetValue(int32 Handle) const { return Entries[Handle].Value; }
+
+  /**
+   * Sets the current value of an entry.
+   * @param Handle The handle of the entry. Must be valid.
+   * @param Value The new value.
+   */
+  void SetValue(int32 Handle, const FLinearColor& Value) { Entries[Handle].Value = Value; }
+
+  /**
+   * Gets the key of the collection instance of an entry.
+   * @param Handle The handle of the entry. Must be valid.
+   * @returns Returns the instance key.
+   */
+  TObjectKey<UMaterialParameterCollectionInstance> GetInstanceKey(int32 Handle) const { return Entries[Handle].InstanceKey; }
+
+  /**
+   * Gets the parameter name of an entry.
+   * @param Handle The handle of the entry. Must be valid.
+   * @returns Returns the parameter name.
+   */
+  const FName& GetParameterName(int32 Handle) const { return Entries[Handle].ParameterName; }
+
+  /**
+   * Gets the number of entries in use.
+   * @returns Returns the number of distinct parameters in the table.
+   */
+  int32 Num() const { return Handles.Num(); }
+
+  /**
+   * Gets the heap memory used by the table.
+   * @returns Returns the allocated size of every entry and lookup, in bytes.
+   */
+  SIZE_T GetAllocatedSize() const;
+
+  /**
+   * Gets the memory the entries would take if every reference held its own copy of the instance, name, and value,
+   * as they did before they were interned.
+   * @returns Returns the size of one copy per reference, in bytes.
+   */
+  SIZE_T GetUninternedSize() const;
+
+private:
+  /**
+   * @struct FEntry
+   * @brief A single interned parameter.
+   */
+  struct FEntry
+  {
+    // The key of the collection instance the parameter is in.
+    TObjectKey<UMaterialParameterCollectionInstance> InstanceKey;
+
+    // The name of the vector parameter.
+    FName ParameterName;
+
+    // The latest value of the parameter.
+    FLinearColor Value;
+
+    // The number of references to the entry. Zero for released entries waiting to be reused.
+    int32 RefCount = 0;
+  };
+
+  // Every entry, indexed by handle.
+  TArray<FEntry> Entries;
+
+  // The released handles, waiting to be reused.
+  TArray<int32> FreeHandles;
+
+  // The handle of each parameter in use.
+  TMap<TPair<TObjectKey<UMaterialParameterCollectionInstance>, FName>, int32> Handles;
+};
\ No newline at end of file
@@ -0,0 +1,839 @@
+﻿// "Copyright (C) Craig Williams, SlashParadox"
+
+#include "UNCollectionSubsystem.h"
+
+#include "Engine/AssetManager.h"
+#include "Engine/StreamableManager.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "Materials/MaterialParameterCollection.h"
+#include "Materials/MaterialParameterCollectionInstance.h"
+#include "UNCollectionPalette.h"
+#include "UNStats.h"
+
+static TAutoConsoleVariable<bool> CVarCoalesceCollectionUpdates(
+  TEXT("UN.Collection.CoalesceUpdates"),
+  false,
+  TEXT("If true, material parameter collection updates are queued, and applied to listeners once per frame."));
+
+static TAutoConsoleVariable<int32> CVarThreadedUpdateCapacity(
+  TEXT("UN.Collection.ThreadedUpdateCapacity"),
+  4096,
+  TEXT("The maximum number of parameter updates other threads can queue per frame. Read when a world is initialized."),
+  ECVF_ReadOnly);
+
+static TAutoConsoleVariable<bool> CVarColorPoolEnabled(
+  TEXT("UN.Collection.ColorPool"),
+  true,
+  TEXT("If true, images that lerp between two collection colors are evaluated together in the collection color pool."));
+
+static TAutoConsoleVariable<bool> CVarColorPoolVectorized(
+  TEXT("UN.Collection.ColorPool.Vectorized"),
+  true,
+  TEXT("If true, the collection color pool is evaluated with vector registers. Otherwise, the scalar fallback is used."));
+
+static TAutoConsoleVariable<bool> CVarColorPoolVerify(
+  TEXT("UN.Collection.ColorPool.Verify"),
+  false,
+  TEXT("If true, the collection color pool runs both its vectorized and scalar paths, and logs any result they disagree on."));
+
+namespace UNCollectionSubsystemPrivate
+{
+  // The listeners waiting on each uninitialized world.
+  static TMap<TObjectKey<UWorld>, TArray<FUNCollectionSubscriber>> PendingWorldInitializations;
+
+  // The shared handle to FWorldDelegates::OnPostWorldInitialization.
+  static FDelegateHandle PostWorldInitializationHandle;
+
+  // The shared handle to FWorldDelegates::OnWorldCleanup.
+  static FDelegateHandle WorldCleanupHandle;
+}
+
+void UUNCollectionSubsystem::Tick(float DeltaTime)
+{
+  Super::Tick(DeltaTime);
+
+  DrainThreadedUpdates();
+  FlushPendingUpdates();
+}
+
+bool UUNCollectionSubsystem::IsTickable() const
+{
+  return !PendingVectorUpdates.IsEmpty() || !PendingScalarUpdates.IsEmpty() || (ThreadedUpdateQueue.IsValid() && !ThreadedUpdateQueue->IsEmpty());
+}
+
+TStatId UUNCollectionSubsystem::GetStatId() const
+{
+  RETURN_QUICK_DECLARE_CYCLE_STAT(UUNCollectionSubsystem, STATGROUP_Tickables);
+}
+
+void UUNCollectionSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+  Super::Initialize(Collection);
+
+  UpdateTransactionDepth = 0;
+  ThreadedUpdateQueue = MakeShared<FUNParameterUpdateQueue, ESPMode::ThreadSafe>(static_cast<uint32>(FMath::Max(CVarThreadedUpdateCapacity.GetValueOnGameThread(), 2)));
+}
+
+void UUNCollectionSubsystem::Deinitialize()
+{
+  for (TPair<TObjectKey<UMaterialParameterCollectionInstance>, FUNCollectionBinding>& Pair : Bindings)
+  {
+    if (UMaterialParameterCollectionInstance* Instance = Pair.Value.Instance.Get())
+    {
+      Instance->OnVectorParameterUpdated().Remove(Pair.Value.VectorDelegateHandle);
+      Instance->OnScalarParameterUpdated().Remove(Pair.Value.ScalarDelegateHandle);
+    }
+  }
+
+  // Listeners can outlive the subsystem, so make sure they don't hold onto stale handles or pool entries.
+  for (const TPair<TObjectKey<UMaterialParameterCollectionInstance>, FUNCollectionBinding>& Pair : Bindings)
+  {
+    for (const TMap<FName, TArray<FUNCollectionSubscriber>>* SubscriberMap : { &Pair.Value.VectorSubscribers, &Pair.Value.ScalarSubscribers })
+    {
+      for (const TPair<FName, TArray<FUNCollectionSubscriber>>& Subscribers : *SubscriberMap)
+      {
+        for (const FUNCollectionSubscriber& Subscriber : Subscribers.Value)
+        {
+          if (Subscriber.Owner.IsValid())
+            Subscriber.Listener->OnCollectionSubscriptionsReleased();
+        }
+      }
+    }
+  }
+
+  for (int32 i = 0; i < ColorPool.Num(); ++i)
+  {
+    for (const FUNCollectionColorPoolListener& PoolListener : ColorPool.GetListeners(i))
+    {
+      if (PoolListener.Owner.IsValid())
+        PoolListener.Listener->CollectionColorPoolIndex = INDEX_NONE;
+    }
+  }
+
+  ColorPool.Empty();
+  ChangedColorPoolIndices.Empty();
+  EvaluatedListeners.Empty();
+  ParameterTable.Empty();
+  Bindings.Empty();
+  PendingVectorUpdates.Empty();
+  PendingScalarUpdates.Empty();
+  DispatchedListeners.Empty();
+  DispatchedListenerSet.Empty();
+  InstanceCache.Empty();
+
+  PreparedPaletteUpdates.Empty();
+  PreparedPalette.Reset();
+  AppliedPalette.Reset();
+
+  for (TPair<FSoftObjectPath, FUNCollectionLoadRequest>& Pair : LoadRequests)
+  {
+    if (Pair.Value.Handle.IsValid())
+      Pair.Value.Handle->CancelHandle();
+  }
+
+  LoadRequests.Empty();
+  FailedLoadPaths.Empty();
+
+  Super::Deinitialize();
+}
+
+UUNCollectionSubsystem* UUNCollectionSubsystem::Get(const UWorld* World)
+{
+  return World ? World->GetSubsystem<UUNCollectionSubsystem>() : nullptr;
+}
+
+SIZE_T UUNCollectionSubsystem::GetAllocatedSize() const
+{
+  SIZE_T Size = Bindings.GetAllocatedSize() + ParameterTable.GetAllocatedSize() + ColorPool.GetAllocatedSize();
+
+  for (const TPair<TObjectKey<UMaterialParameterCollectionInstance>, FUNCollectionBinding>& Binding : Bindings)
+  {
+    Size += Binding.Value.VectorSubscribers.GetAllocatedSize() + Binding.Value.ScalarSubscribers.GetAllocatedSize();
+
+    for (const TPair<FName, TArray<FUNCollectionSubscriber>>& Subscribers : Binding.Value.VectorSubscribers)
+    {
+      Size += Subscribers.Value.GetAllocatedSize();
+    }
+
+    for (const TPair<FName, TArray<FUNCollectionSubscriber>>& Subscribers : Binding.Value.ScalarSubscribers)
+    {
+      Size += Subscribers.Value.GetAllocatedSize();
+    }
+  }
+
+  return Size;
+}
+
+UMaterialParameterCollectionInstance* UUNCollectionSubsystem::GetCollectionInstance(const UMaterialParameterCollection* Collection)
+{
+  if (!Collection)
+    return nullptr;
+
+  if (UMaterialParameterCollectionInstance* CachedInstance = FindCachedCollectionInstance(Collection))
+    return CachedInstance;
+
+  UWorld* World = GetWorld();
+  if (!World)
+    return nullptr;
+
+  // Instances are only settled once the world is initialized, so nothing is cached before then.
+  UMaterialParameterCollectionInstance* Instance = World->GetParameterCollectionInstance(Collection);
+  if (Instance && World->bIsWorldInitialized != 0)
+    InstanceCache.Add(TObjectKey<UMaterialParameterCollection>(Collection), Instance);
+
+  return Instance;
+}
+
+UMaterialParameterCollectionInstance* UUNCollectionSubsystem::FindCachedCollectionInstance(const UMaterialParameterCollection* Collection) const
+{
+  const TWeakObjectPtr<UMaterialParameterCollectionInstance>* CachedInstance = InstanceCache.Find(TObjectKey<UMaterialParameterCollection>(Collection));
+  return CachedInstance ? CachedInstance->Get() : nullptr;
+}
+
+int32 UUNCollectionSubsystem::SubscribeVector(UMaterialParameterCollectionInstance* Instance, const FName& ParameterName, UObject* Owner, FUNCollectionListener* Listener, int32 Slot)
+{
+  if (!Instance || !Owner || !Listener || ParameterName == NAME_None)
+    return INDEX_NONE;
+
+  const TObjectKey<UMaterialParameterCollectionInstance> InstanceKey(Instance);
+  FUNCollectionBinding& Binding = Bindings.FindOrAdd(InstanceKey);
+
+  // Only the first vector subscriber to an instance binds to it. Everyone else shares the binding.
+  Binding.Instance = Instance;
+  if (!Binding.VectorDelegateHandle.IsValid())
+    Binding.VectorDelegateHandle = Instance->OnVectorParameterUpdated().AddUObject(this, &ThisClass::OnVectorParameterUpdated, InstanceKey);
+
+  TArray<FUNCollectionSubscriber>& Subscribers = Binding.VectorSubscribers.FindOrAdd(ParameterName);
+  const bool bFirstSubscriber = Subscribers.IsEmpty();
+  Subscribers.Emplace(Owner, Listener, Slot);
+
+  // Every subscriber to the parameter shares one entry. The value is only read from the instance when nothing
+  // was keeping the entry up to date.
+  bool bAdded = false;
+  const int32 ParameterHandle = ParameterTable.Acquire(InstanceKey, ParameterName, bAdded);
+
+  if (bAdded || bFirstSubscriber)
+  {
+    FLinearColor Value;
+    if (!Instance->GetVectorParameterValue(ParameterName, Value))
+      Value = FLinearColor::White;
+
+    ParameterTable.SetValue(ParameterHandle, Value);
+  }
+
+  return ParameterHandle;
+}
+
+void UUNCollectionSubsystem::UnsubscribeVector(int32 ParameterHandle, const FUNCollectionListener* Listener, int32 Slot)
+{
+  if (!ParameterTable.IsValidHandle(ParameterHandle))
+    return;
+
+  const TObjectKey<UMaterialParameterCollectionInstance> InstanceKey = ParameterTable.GetInstanceKey(ParameterHandle);
+  const FName ParameterName = ParameterTable.GetParameterName(ParameterHandle);
+
+  FUNCollectionBinding* Binding = Bindings.Find(InstanceKey);
+  if (!Binding)
+    return;
+
+  TArray<FUNCollectionSubscriber>* Subscribers = Binding->VectorSubscribers.Find(ParameterName);
+  if (!Subscribers)
+    return;
+
+  for (int32 i = Subscribers->Num() - 1; i >= 0; --i)
+  {
+    const FUNCollectionSubscriber& Subscriber = (*Subscribers)[i];
+    // The owner may already be unreachable when this is called from BeginDestroy, so match the listener instead.
+    if (Subscriber.Slot != Slot || Subscriber.Listener != Listener)
+      continue;
+
+    // The pooled color is keyed on the handle, so it has to go before the handle can be reused.
+    if (FUNCollectionColorPool::IsPooledSlot(Slot))
+      RemoveFromColorPool(Subscriber.Listener);
+
+    // Each subscriber holds its own reference. One that was already pruned released it then.
+    Subscribers->RemoveAtSwap(i, 1, false);
+    ParameterTable.Release(ParameterHandle);
+  }
+
+  if (Subscribers->IsEmpty())
+    Binding->VectorSubscribers.Remove(ParameterName);
+
+  ReleaseBindingIfUnused(InstanceKey);
+}
+
+void UUNCollectionSubsystem::SubscribeScalar(UMaterialParameterCollectionInstance* Instance, const FName& ParameterName, UObject* Owner, FUNCollectionListener* Listener, int32 Slot)
+{
+  if (!Instance || !Owner || !Listener || ParameterName == NAME_None)
+    return;
+
+  const TObjectKey<UMaterialParameterCollectionInstance> InstanceKey(Instance);
+  FUNCollectionBinding& Binding = Bindings.FindOrAdd(InstanceKey);
+
+  // Scalars are bound separately, so instances only used for colors never hear about them.
+  Binding.Instance = Instance;
+  if (!Binding.ScalarDelegateHandle.IsValid())
+    Binding.ScalarDelegateHandle = Instance->OnScalarParameterUpdated().AddUObject(this, &ThisClass::OnScalarParameterUpdated, InstanceKey);
+
+  Binding.ScalarSubscribers.FindOrAdd(ParameterName).Emplace(Owner, Listener, Slot);
+}
+
+void UUNCollectionSubsystem::UnsubscribeScalar(const UMaterialParameterCollectionInstance* Instance, const FName& ParameterName, const FUNCollectionListener* Listener, int32 Slot)
+{
+  const TObjectKey<UMaterialParameterCollectionInstance> InstanceKey(Instance);
+
+  FUNCollectionBinding* Binding = Bindings.Find(InstanceKey);
+  if (!Binding)
+    return;
+
+  TArray<FUNCollectionSubscriber>* Subscribers = Binding->ScalarSubscribers.Find(ParameterName);
+  if (!Subscribers)
+    return;
+
+  Subscribers->RemoveAllSwap([Listener, Slot](const FUNCollectionSubscriber& Subscriber)
+  {
+    return Subscriber.Slot == Slot && Subscriber.Listener == Listener;
+  });
+
+  if (Subscribers->IsEmpty())
+    Binding->ScalarSubscribers.Remove(ParameterName);
+
+  ReleaseBindingIfUnused(InstanceKey);
+}
+
+bool UUNCollectionSubsystem::RequestCollectionLoad(const TSoftObjectPtr<UMaterialParameterCollection>& Collection, UObject* Owner, FUNCollectionListener* Listener)
+{
+  if (Collection.IsNull() || !Owner || !Listener)
+    return false;
+
+  // Requesting a failed load again would only fail again, leaving the listener waiting on it forever.
+  const FSoftObjectPath Path = Collection.ToSoftObjectPath();
+  if (FailedLoadPaths.Contains(Path))
+    return false;
+
+  // Piggyback on an existing load of the same collection, if there is one.
+  if (FUNCollectionLoadRequest* ExistingRequest = LoadRequests.Find(Path))
+  {
+    const bool bAlreadyWaiting = ExistingRequest->Waiters.ContainsByPredicate([Owner](const FUNCollectionSubscriber& Waiter)
+    {
+      return Waiter.Owner.Get() == Owner;
+    });
+
+    if (!bAlreadyWaiting)
+      ExistingRequest->Waiters.Emplace(Owner, Listener, INDEX_NONE);
+
+    return true;
+  }
+
+  LoadRequests.Add(Path).Waiters.Emplace(Owner, Listener, INDEX_NONE);
+
+  TSharedPtr<FStreamableHandle> Handle = UAssetManager::GetStreamableManager().RequestAsyncLoad(Path, FStreamableDelegate::CreateUObject(this, &ThisClass::OnCollectionLoadCompleted, Path));
+
+  // The request is removed if the load failed to start and already called back.
+  if (FUNCollectionLoadRequest* Request = LoadRequests.Find(Path))
+  {
+    Request->Handle = MoveTemp(Handle);
+    return true;
+  }
+
+  return !FailedLoadPaths.Contains(Path);
+}
+
+void UUNCollectionSubsystem::QueueForWorldInitialization(const UWorld* World, UObject* Owner, FUNCollectionListener* Listener)
+{
+  using namespace UNCollectionSubsystemPrivate;
+
+  if (!World || !Owner || !Listener)
+    return;
+
+  check(IsInGameThread());
+
+  if (!PostWorldInitializationHandle.IsValid())
+  {
+    PostWorldInitializationHandle = FWorldDelegates::OnPostWorldInitialization.AddStatic(&UUNCollectionSubsystem::OnPostWorldInitialization);
+    WorldCleanupHandle = FWorldDelegates::OnWorldCleanup.AddStatic(&UUNCollectionSubsystem::OnWorldCleanup);
+  }
+
+  PendingWorldInitializations.FindOrAdd(TObjectKey<UWorld>(World)).Emplace(Owner, Listener, INDEX_NONE);
+}
+
+void UUNCollectionSubsystem::FlushPendingUpdates()
+{
+  if (PendingVectorUpdates.IsEmpty() && PendingScalarUpdates.IsEmpty())
+    return;
+
+  // Only the latest value of each parameter was kept, so each is dispatched once.
+  TMap<TPair<TObjectKey<UMaterialParameterCollectionInstance>, FName>, FLinearColor> VectorUpdates = MoveTemp(PendingVectorUpdates);
+  PendingVectorUpdates.Reset();
+
+  for (const TPair<TPair<TObjectKey<UMaterialParameterCollectionInstance>, FName>, FLinearColor>& Update : VectorUpdates)
+  {
+    DispatchVectorUpdate(Update.Key.Key, Update.Key.Value, Update.Value);
+  }
+
+  TMap<TPair<TObjectKey<UMaterialParameterCollectionInstance>, FName>, float> ScalarUpdates = MoveTemp(PendingScalarUpdates);
+  PendingScalarUpdates.Reset();
+
+  for (const TPair<TPair<TObjectKey<UMaterialParameterCollectionInstance>, FName>, float>& Update : ScalarUpdates)
+  {
+    DispatchScalarUpdate(Update.Key.Key, Update.Key.Value, Update.Value);
+  }
+
+  ApplyDispatchedListeners();
+}
+
+void UUNCollectionSubsystem::BeginUpdateTransaction()
+{
+  ++UpdateTransactionDepth;
+}
+
+void UUNCollectionSubsystem::EndUpdateTransaction()
+{
+  if (!ensureMsgf(UpdateTransactionDepth > 0, TEXT("Unbalanced EndUpdateTransaction")))
+    return;
+
+  if (--UpdateTransactionDepth == 0)
+    FlushPendingUpdates();
+}
+
+bool UUNCollectionSubsystem::ApplyPalette(const UUNCollectionPalette* Palette)
+{
+  return PreparePalette(Palette) && ApplyPreparedPalette();
+}
+
+bool UUNCollectionSubsystem::PreparePalette(const UUNCollectionPalette* Palette)
+{
+  if (!Palette)
+    return false;
+
+  PreparedPaletteUpdates.Reset();
+
+  // Walk backwards, so the last color listed for a parameter is the one kept.
+  const TArray<FUNCollectionPaletteColor>& Colors = Palette->GetColors();
+  TSet<TPair<const UMaterialParameterCollection*, FName>> PreparedParameters;
+  PreparedParameters.Reserve(Colors.Num());
+
+  for (int32 i = Colors.Num() - 1; i >= 0; --i)
+  {
+    const FUNCollectionPaletteColor& Color = Colors[i];
+    const UMaterialParameterCollection* Collection = Color.Collection;
+
+    if (!Collection || !Collection->GetVectorParameterByName(Color.ParameterName))
+    {
+      UE_LOG(LogSlate, Warning, TEXT("[%s] [%s] Parameter not found in collection! Palette: [%s] Collection: [%s] Parameter: [%s]"), *FString(__FUNCTION__), *GetNameSafe(this), *GetNameSafe(Palette), *GetNameSafe(Collection), *Color.ParameterName.ToString());
+      continue;
+    }
+
+    bool bAlreadyPrepared = false;
+    PreparedParameters.Add(MakeTuple(Collection, Color.ParameterName), &bAlreadyPrepared);
+    if (!bAlreadyPrepared)
+      PreparedPaletteUpdates.Emplace(Collection, Color.ParameterName, Color.Color);
+  }
+
+  PreparedPalette = Palette;
+  return true;
+}
+
+bool UUNCollectionSubsystem::ApplyPreparedPalette()
+{
+  // The prepared writes came from the palette, so a palette unloaded in the meantime is not applied.
+  if (!PreparedPalette.IsValid())
+  {
+    PreparedPaletteUpdates.Reset();
+    PreparedPalette.Reset();
+    return false;
+  }
+
+  AppliedPalette = PreparedPalette;
+  PreparedPalette.Reset();
+
+  // Each write broadcasts back into this subsystem. The transaction queues them all, so every listener is
+  // applied once against the whole palette, instead of once per color.
+  BeginUpdateTransaction();
+
+  for (const FUNParameterUpdate& Update : PreparedPaletteUpdates)
+  {
+    UMaterialParameterCollectionInstance* Instance = GetCollectionInstance(Update.Collection.ResolveObjectPtr());
+    if (!Instance)
+      continue;
+
+    // Skip colors the theme shares with the last one, so they don't update the render state for nothing.
+    FLinearColor CurrentValue;
+    if (Instance->GetVectorParameterValue(Update.ParameterName, CurrentValue) && CurrentValue == Update.Value)
+      continue;
+
+    Instance->SetVectorParameterValue(Update.ParameterName, Update.Value);
+  }
+
+  EndUpdateTransaction();
+
+  // Reset rather than emptied, so the next palette is prepared without reallocating.
+  PreparedPaletteUpdates.Reset();
+  return true;
+}
+
+void UUNCollectionSubsystem::UpdateColorPoolEntry(UObject* Owner, FUNCollectionListener* Listener, int32 PrimaryHandle, int32 SecondaryHandle, const FLinearColor& Primary, const FLinearColor& Secondary, float LerpAlpha, const FLinearColor& Result)
+{
+  if (!Owner || !Listener)
+    return;
+
+  if (!CVarColorPoolEnabled.GetValueOnGameThread())
+  {
+    RemoveFromColorPool(Listener);
+    return;
+  }
+
+  const FUNCollectionColorPoolKey Key(PrimaryHandle, SecondaryHandle, Primary, Secondary, LerpAlpha);
+
+  if (Listener->CollectionColorPoolIndex != INDEX_NONE)
+  {
+    // Equal keys always evaluate to the same color, so the listener's entry is already correct.
+    if (ColorPool.GetKey(Listener->CollectionColorPoolIndex) == Key)
+      return;
+
+    ColorPool.Remove(Listener->CollectionColorPoolIndex, Listener);
+  }
+
+  Listener->CollectionColorPoolIndex = ColorPool.Add(Key, Owner, Listener, Primary, Secondary, Result);
+}
+
+void UUNCollectionSubsystem::RemoveFromColorPool(FUNCollectionListener* Listener)
+{
+  if (!Listener || Listener->CollectionColorPoolIndex == INDEX_NONE)
+    return;
+
+  ColorPool.Remove(Listener->CollectionColorPoolIndex, Listener);
+  Listener->CollectionColorPoolIndex = INDEX_NONE;
+}
+
+void UUNCollectionSubsystem::OnVectorParameterUpdated(TPair<FName, FLinearColor> ParameterUpdate, TObjectKey<UMaterialParameterCollectionInstance> InstanceKey)
+{
+  UN_SCOPE_CYCLE_COUNTER(STAT_UNiq_OnVectorParameterUpdated);
+  INC_DWORD_STAT(STAT_UNiq_ParameterUpdates);
+
+  if (IsInUpdateTransaction() || CVarCoalesceCollectionUpdates.GetValueOnGameThread())
+  {
+    PendingVectorUpdates.Add(MakeTuple(InstanceKey, ParameterUpdate.Key), ParameterUpdate.Value);
+    return;
+  }
+
+  DispatchVectorUpdate(InstanceKey, ParameterUpdate.Key, ParameterUpdate.Value);
+  ApplyDispatchedListeners();
+}
+
+void UUNCollectionSubsystem::DispatchVectorUpdate(TObjectKey<UMaterialParameterCollectionInstance> InstanceKey, const FName& ParameterName, const FLinearColor& Value)
+{
+  FUNCollectionBinding* Binding = Bindings.Find(InstanceKey);
+  if (!Binding)
+    return;
+
+  // The instance broadcasts every parameter, including ones nothing here listens to.
+  TArray<FUNCollectionSubscriber>* Subscribers = Binding->VectorSubscribers.Find(ParameterName);
+  if (!Subscribers)
+  {
+    INC_DWORD_STAT(STAT_UNiq_UnsubscribedUpdates);
+    return;
+  }
+
+  INC_DWORD_STAT_BY(STAT_UNiq_UpdateFanOut, Subscribers->Num());
+
+  // Every subscriber reads the one shared value, and each pooled color mixing it is updated once.
+  const int32 ParameterHandle = ParameterTable.Find(InstanceKey, ParameterName);
+  if (ParameterHandle != INDEX_NONE)
+  {
+    ParameterTable.SetValue(ParameterHandle, Value);
+    ColorPool.SetParameterColor(ParameterHandle, Value);
+  }
+
+  // Listeners only store the value here, so the subscribers can't change during the loop.
+  bool bFoundStaleSubscriber = false;
+
+  for (const FUNCollectionSubscriber& Subscriber : *Subscribers)
+  {
+    if (!Subscriber.Owner.IsValid())
+    {
+      bFoundStaleSubscriber = true;
+      continue;
+    }
+
+    // Pooled slots are lerped together when applied, instead of by each listener.
+    if (Subscriber.Listener->IsInCollectionColorPool() && FUNCollectionColorPool::IsPooledSlot(Subscriber.Slot))
+      continue;
+
+    Subscriber.Listener->OnCollectionVectorUpdated(Subscriber.Slot, Value);
+    AddDispatchedListener(Subscriber);
+  }
+
+  if (bFoundStaleSubscriber)
+    PruneStaleSubscribers(InstanceKey, Binding->VectorSubscribers, ParameterName, ParameterHandle);
+}
+
+void UUNCollectionSubsystem::OnScalarParameterUpdated(TPair<FName, float> ParameterUpdate, TObjectKey<UMaterialParameterCollectionInstance> InstanceKey)
+{
+  UN_SCOPE_CYCLE_COUNTER(STAT_UNiq_OnScalarParameterUpdated);
+  INC_DWORD_STAT(STAT_UNiq_ParameterUpdates);
+
+  if (IsInUpdateTransaction() || CVarCoalesceCollectionUpdates.GetValueOnGameThread())
+  {
+    PendingScalarUpdates.Add(MakeTuple(InstanceKey, ParameterUpdate.Key), ParameterUpdate.Value);
+    return;
+  }
+
+  DispatchScalarUpdate(InstanceKey, ParameterUpdate.Key, ParameterUpdate.Value);
+  ApplyDispatchedListeners();
+}
+
+void UUNCollectionSubsystem::DispatchScalarUpdate(TObjectKey<UMaterialParameterCollectionInstance> InstanceKey, const FName& ParameterName, float Value)
+{
+  FUNCollectionBinding* Binding = Bindings.Find(InstanceKey);
+  if (!Binding)
+    return;
+
+  TArray<FUNCollectionSubscriber>* Subscribers = Binding->ScalarSubscribers.Find(ParameterName);
+  if (!Subscribers)
+  {
+    INC_DWORD_STAT(STAT_UNiq_UnsubscribedUpdates);
+    return;
+  }
+
+  INC_DWORD_STAT_BY(STAT_UNiq_UpdateFanOut, Subscribers->Num());
+
+  bool bFoundStaleSubscriber = false;
+
+  for (const FUNCollectionSubscriber& Subscriber : *Subscribers)
+  {
+    if (!Subscriber.Owner.IsValid())
+    {
+      bFoundStaleSubscriber = true;
+      continue;
+    }
+
+    // Scalars are never pooled. Whatever they drive is applied by the listener itself.
+    Subscriber.Listener->OnCollectionScalarUpdated(Subscriber.Slot, Value);
+    AddDispatchedListener(Subscriber);
+  }
+
+  if (bFoundStaleSubscriber)
+    PruneStaleSubscribers(InstanceKey, Binding->ScalarSubscribers, ParameterName, INDEX_NONE);
+}
+
+void UUNCollectionSubsystem::AddDispatchedListener(const FUNCollectionSubscriber& Subscriber)
+{
+  bool bAlreadyDispatched = false;
+  DispatchedListenerSet.Add(Subscriber.Listener, &bAlreadyDispatched);
+  if (!bAlreadyDispatched)
+    DispatchedListeners.Add(Subscriber);
+}
+
+void UUNCollectionSubsystem::PruneStaleSubscribers(TObjectKey<UMaterialParameterCollectionInstance> InstanceKey, TMap<FName, TArray<FUNCollectionSubscriber>>& Subscribers, const FName& ParameterName, int32 ParameterHandle)
+{
+  TArray<FUNCollectionSubscriber>* ParameterSubscribers = Subscribers.Find(ParameterName);
+  if (!ParameterSubscribers)
+    return;
+
+  // Prune any owners that were destroyed without unsubscribing.
+  const int32 NumPruned = ParameterSubscribers->RemoveAllSwap([](const FUNCollectionSubscriber& Subscriber) { return !Subscriber.Owner.IsValid(); });
+
+  // Their owners can never release their references now, so it's done for them. Any pooled colors they shared
+  // are keyed on the handle, and have to go first.
+  if (ParameterHandle != INDEX_NONE)
+  {
+    ColorPool.RemoveStaleListeners(ParameterHandle);
+
+    for (int32 i = 0; i < NumPruned; ++i)
+      ParameterTable.Release(ParameterHandle);
+  }
+
+  if (ParameterSubscribers->IsEmpty())
+    Subscribers.Remove(ParameterName);
+
+  ReleaseBindingIfUnused(InstanceKey);
+}
+
+void UUNCollectionSubsystem::ApplyDispatchedListeners()
+{
+  EvaluateColorPool();
+
+  // Listeners may cause more updates while applying, so apply from a separate list.
+  TArray<FUNCollectionSubscriber> Listeners = MoveTemp(DispatchedListeners);
+  DispatchedListeners.Reset();
+  DispatchedListenerSet.Reset();
+
+  for (const FUNCollectionSubscriber& Listener : Listeners)
+  {
+    if (Listener.Owner.IsValid())
+      Listener.Listener->OnCollectionUpdatesApplied();
+  }
+
+  // Hand the allocation back for the next dispatch.
+  if (DispatchedListeners.IsEmpty())
+  {
+    Listeners.Reset();
+    DispatchedListeners = MoveTemp(Listeners);
+  }
+}
+
+void UUNCollectionSubsystem::ReleaseBindingIfUnused(TObjectKey<UMaterialParameterCollectionInstance> InstanceKey)
+{
+  FUNCollectionBinding* Binding = Bindings.Find(InstanceKey);
+  if (!Binding)
+    return;
+
+  UMaterialParameterCollectionInstance* Instance = Binding->Instance.Get();
+
+  // Each delegate is released on its own, so an instance that only keeps its colors stops hearing about scalars.
+  if (Binding->ScalarSubscribers.IsEmpty() && Binding->ScalarDelegateHandle.IsValid())
+  {
+    if (Instance)
+      Instance->OnScalarParameterUpdated().Remove(Binding->ScalarDelegateHandle);
+
+    Binding->ScalarDelegateHandle.Reset();
+  }
+
+  if (Binding->VectorSubscribers.IsEmpty() && Binding->VectorDelegateHandle.IsValid())
+  {
+    if (Instance)
+      Instance->OnVectorParameterUpdated().Remove(Binding->VectorDelegateHandle);
+
+    Binding->VectorDelegateHandle.Reset();
+  }
+
+  if (!Binding->VectorSubscribers.IsEmpty() || !Binding->ScalarSubscribers.IsEmpty())
+    return;
+
+  Bindings.Remove(InstanceKey);
+}
+
+void UUNCollectionSubsystem::OnCollectionLoadCompleted(FSoftObjectPath Path)
+{
+  FUNCollectionLoadRequest Request;
+  if (!LoadRequests.RemoveAndCopyValue(Path, Request))
+    return;
+
+  const UMaterialParameterCollection* Collection = Cast<UMaterialParameterCollection>(Path.ResolveObject());
+
+  // Failed paths are never requested again, so this is only logged once per path.
+  if (!Collection)
+  {
+    FailedLoadPaths.Add(Path);
+    UE_LOG(LogSlate, Warning, TEXT("[%s] [%s] Unable to load collection! Collection: [%s]"), *FString(__FUNCTION__), *GetNameSafe(this), *Path.ToString());
+  }
+
+  for (const FUNCollectionSubscriber& Waiter : Request.Waiters)
+  {
+    if (Waiter.Owner.IsValid())
+      Waiter.Listener->OnCollectionLoaded(Collection);
+  }
+}
+
+void UUNCollectionSubsystem::OnPostWorldInitialization(UWorld* World, const UWorld::InitializationValues InitializationValues)
+{
+  using namespace UNCollectionSubsystemPrivate;
+
+  TArray<FUNCollectionSubscriber> Waiters;
+  if (!PendingWorldInitializations.RemoveAndCopyValue(TObjectKey<UWorld>(World), Waiters))
+    return;
+
+  ReleaseWorldInitializationBindingsIfUnused();
+
+  for (const FUNCollectionSubscriber& Waiter : Waiters)
+  {
+    if (Waiter.Owner.IsValid())
+      Waiter.Listener->OnCollectionWorldInitialized(World);
+  }
+}
+
+void UUNCollectionSubsystem::OnWorldCleanup(UWorld* World, bool bSessionEnded, bool bCleanupResources)
+{
+  using namespace UNCollectionSubsystemPrivate;
+
+  TArray<FUNCollectionSubscriber> Waiters;
+  if (!PendingWorldInitializations.RemoveAndCopyValue(TObjectKey<UWorld>(World), Waiters))
+    return;
+
+  ReleaseWorldInitializationBindingsIfUnused();
+
+  // Otherwise the listeners would keep waiting on a world that will never initialize.
+  for (const FUNCollectionSubscriber& Waiter : Waiters)
+  {
+    if (Waiter.Owner.IsValid())
+      Waiter.Listener->OnCollectionWorldCleanedUp(World);
+  }
+}
+
+void UUNCollectionSubsystem::ReleaseWorldInitializationBindingsIfUnused()
+{
+  using namespace UNCollectionSubsystemPrivate;
+
+  if (!PendingWorldInitializations.IsEmpty())
+    return;
+
+  FWorldDelegates::OnPostWorldInitialization.Remove(PostWorldInitializationHandle);
+  FWorldDelegates::OnWorldCleanup.Remove(WorldCleanupHandle);
+  PostWorldInitializationHandle.Reset();
+  WorldCleanupHandle.Reset();
+}
+
+void UUNCollectionSubsystem::DrainThreadedUpdates()
+{
+  if (!ThreadedUpdateQueue.IsValid())
+    return;
+
+  // Writing to the instances broadcasts back into this subsystem. Coalesce those, so they're applied once.
+  BeginUpdateTransaction();
+
+  // Only drain what is here now, so producers can't keep the game thread in this loop.
+  const uint32 MaxUpdates = ThreadedUpdateQueue->GetCapacity();
+  FUNParameterUpdate Update;
+
+  for (uint32 i = 0; i < MaxUpdates && ThreadedUpdateQueue->Dequeue(Update); ++i)
+  {
+    // The collection may have been collected since the update was queued.
+    if (UMaterialParameterCollectionInstance* Instance = GetCollectionInstance(Update.Collection.ResolveObjectPtr()))
+      Instance->SetVectorParameterValue(Update.ParameterName, Update.Value);
+  }
+
+  EndUpdateTransaction();
+}
+
+void UUNCollectionSubsystem::EvaluateColorPool()
+{
+  if (!ColorPool.HasDirtyEntries())
+    return;
+
+  // Listeners may cause more updates when told, so tell them from a separate list.
+  TArray<int32> ChangedIndices = MoveTemp(ChangedColorPoolIndices);
+  ChangedIndices.Reset();
+
+  ColorPool.Evaluate(ChangedIndices, CVarColorPoolVectorized.GetValueOnGameThread(), CVarColorPoolVerify.GetValueOnGameThread());
+
+  // Listeners may leave their entry when told, so each entry's listeners are told from a separate list.
+  TArray<FUNCollectionColorPoolListener> Listeners = MoveTemp(EvaluatedListeners);
+
+  for (const int32 Index : ChangedIndices)
+  {
+    const FLinearColor Result = ColorPool.GetResult(Index);
+    Listeners = ColorPool.GetListeners(Index);
+
+    for (const FUNCollectionColorPoolListener& PoolListener : Listeners)
+    {
+      // Listeners that left the entry while telling earlier ones are skipped.
+      if (PoolListener.Owner.IsValid() && PoolListener.Listener->CollectionColorPoolIndex == Index)
+        PoolListener.Listener->OnCollectionColorEvaluated(Result);
+    }
+  }
+
+  if (EvaluatedListeners.IsEmpty())
+  {
+    Listeners.Reset();
+    EvaluatedListeners = MoveTemp(Listeners);
+  }
+
+  // Hand the allocation back for the next evaluation.
+  if (ChangedColorPoolIndices.IsEmpty())
+  {
+    ChangedIndices.Reset();
+    ChangedColorPoolIndices = MoveTemp(ChangedIndices);
+  }
+}
\ No newline at end of file
@@ -0,0 +1,517 @@
+﻿// "Copyright (C) Craig Williams, SlashParadox"
+
+#pragma once
+
+#include "Engine/World.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/ObjectKey.h"
+#include "UObject/SoftObjectPath.h"
+#include "UNCollectionColorPool.h"
+#include "UNCollectionParameterTable.h"
+#include "UNParameterUpdateQueue.h"
+
+#include "UNCollectionSubsystem.generated.h"
+
+class UMaterialParameterCollection;
+class UMaterialParameterCollectionInstance;
+class UUNCollectionPalette;
+struct FStreamableHandle;
+
+/**
+ * @class FUNCollectionListener
+ * @brief A native listener for parameter updates pushed out by the UUNCollectionSubsystem.
+ */
+class UNIQ_API FUNCollectionListener
+{
+  friend class UUNCollectionSubsystem;
+
+public:
+  FUNCollectionListener()
+    : CollectionColorPoolIndex(INDEX_NONE)
+  {
+  }
+
+  virtual ~FUNCollectionListener() = default;
+
+  /**
+   * Called when a subscribed vector parameter is updated. Only store the value here. Any work that depends on
+   * it belongs in OnCollectionUpdatesApplied, which is called once after a batch of updates. The value is also
+   * in the subsystem's parameter table, under the handle returned when subscribing.
+   * @param Slot The slot the listener subscribed with.
+   * @param Value The new value of the parameter.
+   */
+  virtual void OnCollectionVectorUpdated(int32 Slot, const FLinearColor& Value) = 0;
+
+  /**
+   * Called when a subscribed scalar parameter is updated. As with vectors, only store the value here.
+   * @param Slot The slot the listener subscribed with. Scalar slots are separate from vector slots.
+   * @param Value The new value of the parameter.
+   */
+  virtual void OnCollectionScalarUpdated(int32 Slot, float Value) {}
+
+  /** Called once after the listener has received one or more updates, to apply them all at once.*/
+  virtual void OnCollectionUpdatesApplied() = 0;
+
+  /**
+   * Called when a collection requested through UUNCollectionSubsystem::RequestCollectionLoad finishes loading.
+   * @param Collection The loaded collection. This is null if the load failed.
+   */
+  virtual void OnCollectionLoaded(const UMaterialParameterCollection* Collection) {}
+
+  /**
+   * Called when a world queued with UUNCollectionSubsystem::QueueForWorldInitialization finishes initializing.
+   * @param World The initialized world.
+   */
+  virtual void OnCollectionWorldInitialized(UWorld* World) {}
+
+  /**
+   * Called when a world queued with UUNCollectionSubsystem::QueueForWorldInitialization is cleaned up before it
+   * initializes. The listener is no longer queued, and won't be told about that world again.
+   * @param World The world being cleaned up.
+   */
+  virtual void OnCollectionWorldCleanedUp(UWorld* World) {}
+
+  /**
+   * Called when the listener's color pool entry evaluates to a new color. Pooled listeners are not sent
+   * OnCollectionVectorUpdated or OnCollectionUpdatesApplied for their pooled slots. The entry may be shared with
+   * other listeners. See UUNCollectionSubsystem::UpdateColorPoolEntry.
+   * @param Color The newly evaluated color.
+   */
+  virtual void OnCollectionColorEvaluated(const FLinearColor& Color) {}
+
+  /**
+   * Called when the subsystem the listener is subscribed through deinitializes. Every subscription and parameter
+   * handle the listener holds is gone, and must not be unsubscribed or read. Don't call back into the subsystem here.
+   */
+  virtual void OnCollectionSubscriptionsReleased() {}
+
+  /**
+   * Checks if the listener has an entry in its subsystem's color pool.
+   * @returns Returns true if the listener's color is evaluated by the pool.
+   */
+  bool IsInCollectionColorPool() const { return CollectionColorPoolIndex != INDEX_NONE; }
+
+private:
+  // The listener's entry in its subsystem's color pool, or INDEX_NONE if it is not pooled.
+  int32 CollectionColorPoolIndex;
+};
+
+/**
+ * @struct FUNCollectionSubscriber
+ * @brief A single listener subscribed to a parameter in a collection instance.
+ */
+struct FUNCollectionSubscriber
+{
+  FUNCollectionSubscriber()
+    : Listener(nullptr)
+    , Slot(INDEX_NONE)
+  {
+  }
+
+  FUNCollectionSubscriber(UObject* InOwner, FUNCollectionListener* InListener, int32 InSlot)
+    : Owner(InOwner)
+    , Listener(InListener)
+    , Slot(InSlot)
+  {
+  }
+
+  // The object that owns the Listener. The Listener is only valid while this is.
+  TWeakObjectPtr<UObject> Owner;
+
+  // The listener to push updates to.
+  FUNCollectionListener* Listener;
+
+  // A user-defined slot, passed back to the Listener on updates.
+  int32 Slot;
+};
+
+/**
+ * @struct FUNCollectionBinding
+ * @brief The single binding to a collection instance, shared by all of its subscribers.
+ */
+struct FUNCollectionBinding
+{
+  // The collection instance that is bound to.
+  TWeakObjectPtr<UMaterialParameterCollectionInstance> Instance;
+
+  // A handle to the delegate bound to the Instance's vector updates.
+  FDelegateHandle VectorDelegateHandle;
+
+  // The subscribers for each vector parameter name.
+  TMap<FName, TArray<FUNCollectionSubscriber>> VectorSubscribers;
+
+  // A handle to the delegate bound to the Instance's scalar updates.
+  FDelegateHandle ScalarDelegateHandle;
+
+  // The subscribers for each scalar parameter name.
+  TMap<FName, TArray<FUNCollectionSubscriber>> ScalarSubscribers;
+};
+
+/**
+ * @struct FUNCollectionLoadRequest
+ * @brief A single async load of a collection, shared by every listener waiting on it.
+ */
+struct FUNCollectionLoadRequest
+{
+  // The streamable handle of the load.
+  TSharedPtr<FStreamableHandle> Handle;
+
+  // The listeners waiting on the load to finish.
+  TArray<FUNCollectionSubscriber> Waiters;
+};
+
+/**
+ * @class UUNCollectionSubsystem
+ * @brief A registry of (collection, parameter) subscriptions for a world. Each collection instance is bound
+ * to only once, and each vector or scalar update is only sent to the listeners subscribed to that exact parameter.
+ * With UN.Collection.CoalesceUpdates set, updates are queued and applied once per frame before Slate paints.
+ * Each subscribed vector parameter is interned into a parameter table, so its value is stored once and subscribers
+ * only hold a small handle to it. Listeners that only lerp between two colors can join the color pool, which shares
+ * one entry between listeners with the same inputs, evaluates every entry in one vectorized pass per batch of
+ * updates, and only calls back the listeners whose color actually changed. Palettes are written as one update
+ * transaction, so a whole theme swap only updates each listener once.
+ */
+UCLASS()
+class UNIQ_API UUNCollectionSubsystem : public UTickableWorldSubsystem
+{
+  GENERATED_BODY()
+
+public:
+  // Begin FTickableGameObject Interface
+  virtual void Tick(float DeltaTime) override;
+  virtual bool IsTickable() const override;
+  virtual bool IsTickableWhenPaused() const override { return true; }
+  virtual bool IsTickableInEditor() const override { return true; }
+  virtual TStatId GetStatId() const override;
+  // End FTickableGameObject Interface
+
+  // Begin USubsystem Interface
+  virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+  virtual void Deinitialize() override;
+  // End USubsystem Interface
+
+  /**
+   * Gets the collection subsystem for a world.
+   * @param World The world to get the subsystem of.
+   * @returns Returns the subsystem, if available.
+   */
+  static UUNCollectionSubsystem* Get(const UWorld* World);
+
+  /**
+   * Gets a collection's instance in this world. Lookups are cached until the world tears down.
+   * @param Collection The parameter collection used as a key.
+   * @returns Returns the collection's world instance, if available. The world must be initialized!
+   */
+  UMaterialParameterCollectionInstance* GetCollectionInstance(const UMaterialParameterCollection* Collection);
+
+  /**
+   * Finds a collection's instance in the cache, without falling back to the world.
+   * @param Collection The parameter collection used as a key.
+   * @returns Returns the cached collection instance, if any.
+   */
+  UMaterialParameterCollectionInstance* FindCachedCollectionInstance(const UMaterialParameterCollection* Collection) const;
+
+  /**
+   * Subscribes a listener to a vector parameter of a collection instance.
+   * @param Instance The collection instance to listen to.
+   * @param ParameterName The name of the vector parameter to listen to.
+   * @param Owner The object that owns the Listener.
+   * @param Listener The listener to push updates to.
+   * @param Slot A user-defined slot, passed back to the Listener on updates.
+   * @returns Returns the parameter's handle in the parameter table, shared with every other subscriber to it.
+   * Hold onto it to read the value, and to unsubscribe. INDEX_NONE if nothing was subscribed.
+   */
+  int32 SubscribeVector(UMaterialParameterCollectionInstance* Instance, const FName& ParameterName, UObject* Owner, FUNCollectionListener* Listener, int32 Slot);
+
+  /**
+   * Unsubscribes a listener from a vector parameter of a collection instance, releasing its parameter handle.
+   * Matches on the listener itself, so this still works while its owner is being destroyed.
+   * @param ParameterHandle The handle returned when subscribing.
+   * @param Listener The listener that subscribed.
+   * @param Slot The slot the listener subscribed with.
+   */
+  void UnsubscribeVector(int32 ParameterHandle, const FUNCollectionListener* Listener, int32 Slot);
+
+  /**
+   * Subscribes a listener to a scalar parameter of a collection instance.
+   * @param Instance The collection instance to listen to.
+   * @param ParameterName The name of the scalar parameter to listen to.
+   * @param Owner The object that owns the Listener.
+   * @param Listener The listener to push updates to.
+   * @param Slot A user-defined slot, passed back to the Listener on updates.
+   */
+  void SubscribeScalar(UMaterialParameterCollectionInstance* Instance, const FName& ParameterName, UObject* Owner, FUNCollectionListener* Listener, int32 Slot);
+
+  /**
+   * Unsubscribes a listener from a scalar parameter of a collection instance.
+   * @param Instance The collection instance that was listened to.
+   * @param ParameterName The name of the scalar parameter that was listened to.
+   * @param Listener The listener that subscribed.
+   * @param Slot The slot the listener subscribed with.
+   */
+  void UnsubscribeScalar(const UMaterialParameterCollectionInstance* Instance, const FName& ParameterName, const FUNCollectionListener* Listener, int32 Slot);
+
+  /**
+   * Asynchronously loads a collection through the streamable manager. Requests for the same collection are
+   * coalesced into one load. The listener is told through FUNCollectionListener::OnCollectionLoaded. Collections
+   * that failed to load are not requested again, so listeners can fall back instead of waiting forever.
+   * @param Collection The collection to load.
+   * @param Owner The object that owns the Listener.
+   * @param Listener The listener to tell when the load finishes.
+   * @returns Returns true if the collection is loading, and the listener will be told. False if the collection
+   * already failed to load, or nothing was requested.
+   */
+  bool RequestCollectionLoad(const TSoftObjectPtr<UMaterialParameterCollection>& Collection, UObject* Owner, FUNCollectionListener* Listener);
+
+  /**
+   * Queues a listener to be told once a world is initialized. Every listener waiting on a world shares a single
+   * binding to FWorldDelegates::OnPostWorldInitialization, and they are all told in one pass. The listener is
+   * told through FUNCollectionListener::OnCollectionWorldInitialized, or through
+   * FUNCollectionListener::OnCollectionWorldCleanedUp if the world never initializes. Listeners are not de-duplicated.
+   * @param World The uninitialized world to wait on.
+   * @param Owner The object that owns the Listener.
+   * @param Listener The listener to tell when the world is initialized.
+   */
+  static void QueueForWorldInitialization(const UWorld* World, UObject* Owner, FUNCollectionListener* Listener);
+
+  /** Immediately applies every queued parameter update. Each affected listener is applied at most once.*/
+  void FlushPendingUpdates();
+
+  /**
+   * Begins an update transaction. Every parameter update until the matching EndUpdateTransaction is queued,
+   * regardless of settings. Transactions can be nested.
+   */
+  void BeginUpdateTransaction();
+
+  /** Ends an update transaction. Once the outermost transaction ends, every queued update is applied as one batch.*/
+  void EndUpdateTransaction();
+
+  /**
+   * Checks if an update transaction is open.
+   * @returns Returns true if parameter updates are currently being queued for the end of a transaction.
+   */
+  bool IsInUpdateTransaction() const { return UpdateTransactionDepth > 0; }
+
+  /**
+   * Prepares and applies a palette as one update transaction. See PreparePalette and ApplyPreparedPalette.
+   * @param Palette The palette to apply.
+   * @returns Returns true if the palette was applied.
+   */
+  UFUNCTION(BlueprintCallable, BlueprintCosmetic, Category = "Collection Palette")
+  bool ApplyPalette(const UUNCollectionPalette* Palette);
+
+  /**
+   * Resolves a palette into its writes, ahead of applying it. Duplicate and missing parameters are dropped
+   * here, so applying it later is only the writes. Preparing another palette replaces the prepared one.
+   * @param Palette The palette to prepare.
+   * @returns Returns true if the palette was prepared.
+   */
+  UFUNCTION(BlueprintCallable, BlueprintCosmetic, Category = "Collection Palette")
+  bool PreparePalette(const UUNCollectionPalette* Palette);
+
+  /**
+   * Writes the prepared palette into its collections as one update transaction. Colors the collections already
+   * hold are skipped, whoever set them. Every affected listener is then applied, and pooled colors are
+   * evaluated, exactly once.
+   * @returns Returns true if a prepared palette was applied.
+   */
+  UFUNCTION(BlueprintCallable, BlueprintCosmetic, Category = "Collection Palette")
+  bool ApplyPreparedPalette();
+
+  /**
+   * Gets the palette that was last applied.
+   * @returns Returns the applied palette, if it is still loaded.
+   */
+  UFUNCTION(BlueprintPure, Category = "Collection Palette")
+  const UUNCollectionPalette* GetAppliedPalette() const { return AppliedPalette.Get(); }
+
+  /**
+   * Gets the thread-safe queue of vector parameter writes. Hand this to worker threads once, on the game thread.
+   * Everything in it is written into the collections once per frame, and applied as one batch of updates.
+   * @returns Returns the threaded update queue. It stays valid after the subsystem is gone, but is no longer drained.
+   */
+  TSharedRef<FUNParameterUpdateQueue, ESPMode::ThreadSafe> GetThreadedUpdateQueue() const { return ThreadedUpdateQueue.ToSharedRef(); }
+
+  /**
+   * Gets the table of every subscribed vector parameter, holding each one's current value.
+   * @returns Returns the parameter table.
+   */
+  const FUNCollectionParameterTable& GetParameterTable() const { return ParameterTable; }
+
+  /**
+   * Gets the pool of colors evaluated for pooled listeners.
+   * @returns Returns the color pool.
+   */
+  const FUNCollectionColorPool& GetColorPool() const { return ColorPool; }
+
+  /**
+   * Gets the number of distinct colors in the color pool, no matter how many listeners share each.
+   * @returns Returns the number of color pool entries.
+   */
+  int32 GetNumPooledColors() const { return ColorPool.NumEntries(); }
+
+  /**
+   * Gets the heap memory used to bind listeners. Scratch lists kept around between updates are not included.
+   * @returns Returns the allocated size of every binding, subscriber, interned parameter, and pooled color, in bytes.
+   */
+  SIZE_T GetAllocatedSize() const;
+
+  /**
+   * Adds a listener to the color pool, or moves it to the entry of its new inputs. Listeners with the same inputs
+   * share an entry. Updates to its slot 0 and 1 subscriptions are then lerped by the pool, once per entry, and the
+   * result is sent through FUNCollectionListener::OnCollectionColorEvaluated. Call this whenever the listener
+   * computes its color itself, so the pool stays in step with it.
+   * @param Owner The object that owns the Listener.
+   * @param Listener The listener to pool.
+   * @param PrimaryHandle The parameter handle of the listener's slot 0 subscription, or INDEX_NONE if it has none.
+   * @param SecondaryHandle The parameter handle of the listener's slot 1 subscription, or INDEX_NONE if it has none.
+   * @param Primary The listener's slot 0 color.
+   * @param Secondary The listener's slot 1 color.
+   * @param LerpAlpha The linear interpolation alpha between the colors.
+   * @param Result The color the listener is currently displaying.
+   */
+  void UpdateColorPoolEntry(UObject* Owner, FUNCollectionListener* Listener, int32 PrimaryHandle, int32 SecondaryHandle, const FLinearColor& Primary, const FLinearColor& Secondary, float LerpAlpha, const FLinearColor& Result);
+
+  /**
+   * Removes a listener from the color pool. It is sent OnCollectionUpdatesApplied again afterwards.
+   * @param Listener The listener to remove.
+   */
+  void RemoveFromColorPool(FUNCollectionListener* Listener);
+
+private:
+  /**
+   * A delegate called upon a bound collection instance updating a vector value.
+   * @param ParameterUpdate The parameter in the collection that was updated.
+   * @param InstanceKey The key of the collection instance that was updated.
+   */
+  void OnVectorParameterUpdated(TPair<FName, FLinearColor> ParameterUpdate, TObjectKey<UMaterialParameterCollectionInstance> InstanceKey);
+
+  /**
+   * Sends a vector update to every subscriber of the parameter, and queues them to be applied.
+   * @param InstanceKey The key of the collection instance that was updated.
+   * @param ParameterName The name of the parameter that was updated.
+   * @param Value The new value of the parameter.
+   */
+  void DispatchVectorUpdate(TObjectKey<UMaterialParameterCollectionInstance> InstanceKey, const FName& ParameterName, const FLinearColor& Value);
+
+  /**
+   * A delegate called upon a bound collection instance updating a scalar value.
+   * @param ParameterUpdate The parameter in the collection that was updated.
+   * @param InstanceKey The key of the collection instance that was updated.
+   */
+  void OnScalarParameterUpdated(TPair<FName, float> ParameterUpdate, TObjectKey<UMaterialParameterCollectionInstance> InstanceKey);
+
+  /**
+   * Sends a scalar update to every subscriber of the parameter, and queues them to be applied.
+   * @param InstanceKey The key of the collection instance that was updated.
+   * @param ParameterName The name of the parameter that was updated.
+   * @param Value The new value of the parameter.
+   */
+  void DispatchScalarUpdate(TObjectKey<UMaterialParameterCollectionInstance> InstanceKey, const FName& ParameterName, float Value);
+
+  /**
+   * Queues a dispatched subscriber to be applied, unless its listener already is.
+   * @param Subscriber The subscriber that was dispatched to.
+   */
+  void AddDispatchedListener(const FUNCollectionSubscriber& Subscriber);
+
+  /**
+   * Removes every subscriber of a parameter whose owner was destroyed without unsubscribing.
+   * @param InstanceKey The key of the collection instance the subscribers are bound to.
+   * @param Subscribers The subscribers of each parameter, either vector or scalar.
+   * @param ParameterName The name of the parameter to prune.
+   * @param ParameterHandle The parameter table handle each pruned subscriber holds, or INDEX_NONE for scalars.
+   */
+  void PruneStaleSubscribers(TObjectKey<UMaterialParameterCollectionInstance> InstanceKey, TMap<FName, TArray<FUNCollectionSubscriber>>& Subscribers, const FName& ParameterName, int32 ParameterHandle);
+
+  /** Applies every listener that was dispatched to since the last apply.*/
+  void ApplyDispatchedListeners();
+
+  /** Writes every update in the ThreadedUpdateQueue into its collection instance.*/
+  void DrainThreadedUpdates();
+
+  /** Evaluates every updated entry of the ColorPool, and tells each listener whose color changed.*/
+  void EvaluateColorPool();
+
+  /**
+   * Unbinds from a collection instance once nothing is subscribed to it anymore.
+   * @param InstanceKey The key of the collection instance to check.
+   */
+  void ReleaseBindingIfUnused(TObjectKey<UMaterialParameterCollectionInstance> InstanceKey);
+
+  /**
+   * A delegate called upon a requested collection finishing its load.
+   * @param Path The path of the loaded collection.
+   */
+  void OnCollectionLoadCompleted(FSoftObjectPath Path);
+
+  /**
+   * A delegate called upon any world being initialized. Tells every listener waiting on that world.
+   * @param World The initialized world.
+   * @param InitializationValues The values the world was initialized with.
+   */
+  static void OnPostWorldInitialization(UWorld* World, const UWorld::InitializationValues InitializationValues);
+
+  /**
+   * A delegate called upon any world being cleaned up. Drops and tells every listener still waiting on that world.
+   * @param World The world being cleaned up.
+   * @param bSessionEnded If true, the session has ended.
+   * @param bCleanupResources If true, the world's resources are being cleaned up.
+   */
+  static void OnWorldCleanup(UWorld* World, bool bSessionEnded, bool bCleanupResources);
+
+  /** Unbinds from the world delegates once no listener is waiting on a world anymore.*/
+  static void ReleaseWorldInitializationBindingsIfUnused();
+
+private:
+  // The binding for each collection instance with at least one subscriber.
+  TMap<TObjectKey<UMaterialParameterCollectionInstance>, FUNCollectionBinding> Bindings;
+
+  // The latest queued value of each updated vector parameter, when coalescing updates.
+  TMap<TPair<TObjectKey<UMaterialParameterCollectionInstance>, FName>, FLinearColor> PendingVectorUpdates;
+
+  // The latest queued value of each updated scalar parameter, when coalescing updates.
+  TMap<TPair<TObjectKey<UMaterialParameterCollectionInstance>, FName>, float> PendingScalarUpdates;
+
+  // The queue of vector parameter writes from any thread.
+  TSharedPtr<FUNParameterUpdateQueue, ESPMode::ThreadSafe> ThreadedUpdateQueue;
+
+  // The number of open update transactions. While above zero, updates are coalesced regardless of settings.
+  int32 UpdateTransactionDepth;
+
+  // The resolved writes of the prepared palette. Empty once it is applied.
+  TArray<FUNParameterUpdate> PreparedPaletteUpdates;
+
+  // The palette resolved into the PreparedPaletteUpdates, waiting to be applied.
+  TWeakObjectPtr<const UUNCollectionPalette> PreparedPalette;
+
+  // The palette last applied.
+  TWeakObjectPtr<const UUNCollectionPalette> AppliedPalette;
+
+  // The evaluated colors of every pooled listener.
+  FUNCollectionColorPool ColorPool;
+
+  // The pool entries that changed in the last evaluation. Kept around to reuse the allocation.
+  TArray<int32> ChangedColorPoolIndices;
+
+  // The listeners of the pool entry being told about its new color. Kept around to reuse the allocation.
+  TArray<FUNCollectionColorPoolListener> EvaluatedListeners;
+
+  // The interned value of every subscribed vector parameter.
+  FUNCollectionParameterTable ParameterTable;
+
+  // The listeners dispatched to that still need to be applied.
+  TArray<FUNCollectionSubscriber> DispatchedListeners;
+
+  // The listeners in the DispatchedListeners, to apply each at most once. Owners may hold more than one listener.
+  TSet<const FUNCollectionListener*> DispatchedListenerSet;
+
+  // The world's instance of each collection looked up so far.
+  TMap<TObjectKey<UMaterialParameterCollection>, TWeakObjectPtr<UMaterialParameterCollectionInstance>> InstanceCache;
+
+  // The in-flight async loads, by collection path.
+  TMap<FSoftObjectPath, FUNCollectionLoadRequest> LoadRequests;
+
+  // The paths of every collection that failed to load.
+  TSet<FSoftObjectPath> FailedLoadPaths;
+};
\ No newline at end of file
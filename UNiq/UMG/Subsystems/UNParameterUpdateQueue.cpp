@@ -0,0 +1,70 @@
+﻿// "Copyright (C) Craig Williams, SlashParadox"
+
+#include "UNParameterUpdateQueue.h"
+
+FUNParameterUpdateQueue::FUNParameterUpdateQueue(uint32 InCapacity)
+  : Mask(FMath::RoundUpToPowerOfTwo(FMath::Max(InCapacity, 2u)) - 1)
+  , EnqueuePosition(0)
+  , DequeuePosition(0)
+{
+  Cells = MakeUnique<FCell[]>(Mask + 1);
+
+  for (uint64 i = 0; i <= Mask; ++i)
+  {
+    Cells[i].Sequence.store(i, std::memory_order_relaxed);
+  }
+}
+
+bool FUNParameterUpdateQueue::Enqueue(const FUNParameterUpdate& Update)
+{
+  uint64 Position = EnqueuePosition.load(std::memory_order_relaxed);
+  FCell* Cell = nullptr;
+
+  for (;;)
+  {
+    Cell = &Cells[Position & Mask];
+    const uint64 Sequence = Cell->Sequence.load(std::memory_order_acquire);
+    const int64 Difference = static_cast<int64>(Sequence) - static_cast<int64>(Position);
+
+    // The cell is free for this position. Claim it, or retry from wherever another producer left off.
+    if (Difference == 0)
+    {
+      if (EnqueuePosition.compare_exchange_weak(Position, Position + 1, std::memory_order_relaxed))
+        break;
+    }
+    else if (Difference < 0)
+    {
+      // The consumer hasn't freed this cell yet, so the queue is full.
+      return false;
+    }
+    else
+    {
+      Position = EnqueuePosition.load(std::memory_order_relaxed);
+    }
+  }
+
+  Cell->Update = Update;
+  Cell->Sequence.store(Position + 1, std::memory_order_release);
+  return true;
+}
+
+bool FUNParameterUpdateQueue::Dequeue(FUNParameterUpdate& OutUpdate)
+{
+  const uint64 Position = DequeuePosition.load(std::memory_order_relaxed);
+  FCell& Cell = Cells[Position & Mask];
+
+  // The producer has not finished writing this cell yet.
+  const uint64 Sequence = Cell.Sequence.load(std::memory_order_acquire);
+  if (static_cast<int64>(Sequence) - static_cast<int64>(Position + 1) < 0)
+    return false;
+
+  OutUpdate = Cell.Update;
+  Cell.Sequence.store(Position + Mask + 1, std::memory_order_release);
+  DequeuePosition.store(Position + 1, std::memory_order_relaxed);
+  return true;
+}
+
+bool FUNParameterUpdateQueue::IsEmpty() const
+{
+  return DequeuePosition.load(std::memory_order_relaxed) == EnqueuePosition.load(std::memory_order_relaxed);
+}
\ No newline at end of file
@@ -0,0 +1,105 @@
+﻿// "Copyright (C) Craig Williams, SlashParadox"
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/ObjectKey.h"
+
+#include <atomic>
+
+class UMaterialParameterCollection;
+
+/**
+ * @struct FUNParameterUpdate
+ * @brief A single vector parameter write, queued to be applied on the game thread.
+ */
+struct FUNParameterUpdate
+{
+  FUNParameterUpdate()
+    : Value(FLinearColor::White)
+  {
+  }
+
+  FUNParameterUpdate(const UMaterialParameterCollection* InCollection, const FName& InParameterName, const FLinearColor& InValue)
+    : Collection(InCollection)
+    , ParameterName(InParameterName)
+    , Value(InValue)
+  {
+  }
+
+  // The collection to write to. Only resolved on the game thread, and the update is skipped if it is gone by then.
+  TObjectKey<UMaterialParameterCollection> Collection;
+
+  // The name of the vector parameter to write to.
+  FName ParameterName;
+
+  // The value to write.
+  FLinearColor Value;
+};
+
+/**
+ * @class FUNParameterUpdateQueue
+ * @brief A bounded, lock-free, multi-producer queue of parameter updates. Any thread can enqueue, and the
+ * game thread drains it. All storage is allocated up front, so enqueueing never allocates.
+ */
+class UNIQ_API FUNParameterUpdateQueue
+{
+public:
+  /**
+   * Creates the queue.
+   * @param InCapacity The maximum number of queued updates. Rounded up to a power of two.
+   */
+  explicit FUNParameterUpdateQueue(uint32 InCapacity);
+
+  FUNParameterUpdateQueue(const FUNParameterUpdateQueue&) = delete;
+  FUNParameterUpdateQueue& operator=(const FUNParameterUpdateQueue&) = delete;
+
+  /**
+   * Enqueues an update. Safe to call from any thread.
+   * @param Update The update to enqueue.
+   * @returns Returns false if the queue is full, and the update was dropped.
+   */
+  bool Enqueue(const FUNParameterUpdate& Update);
+
+  /**
+   * Dequeues the oldest update. Only call from the single consuming thread.
+   * @param OutUpdate The dequeued update.
+   * @returns Returns false if the queue is empty.
+   */
+  bool Dequeue(FUNParameterUpdate& OutUpdate);
+
+  /**
+   * Checks if the queue is empty. This is only a snapshot while producers are active.
+   * @returns Returns true if nothing is queued.
+   */
+  bool IsEmpty() const;
+
+  /**
+   * Gets the maximum number of queued updates.
+   * @returns Returns the capacity of the queue.
+   */
+  uint32 GetCapacity() const { return static_cast<uint32>(Mask + 1); }
+
+private:
+  /**
+   * @struct FCell
+   * @brief A single slot in the ring buffer. The sequence tells producers and the consumer whose turn it is.
+   */
+  struct FCell
+  {
+    std::atomic<uint64> Sequence;
+    FUNParameterUpdate Update;
+  };
+
+  // The ring buffer of cells.
+  TUniquePtr<FCell[]> Cells;
+
+  // The mask used to wrap positions into the ring buffer.
+  uint64 Mask;
+
+  // The next position to enqueue at. Kept on its own cache line, away from the consumer.
+  alignas(PLATFORM_CACHE_LINE_SIZE) std::atomic<uint64> EnqueuePosition;
+
+  // The next position to dequeue from.
+  alignas(PLATFORM_CACHE_LINE_SIZE) std::atomic<uint64> DequeuePosition;
+};
\ No newline at end of file
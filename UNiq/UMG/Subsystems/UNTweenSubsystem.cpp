@@ -0,0 +1,111 @@
+﻿// "Copyright (C) Craig Williams, SlashParadox"
+
+#include "UNTweenSubsystem.h"
+
+#include "Engine/World.h"
+#include "UNImage.h"
+
+void UUNTweenSubsystem::Tick(float DeltaTime)
+{
+  Super::Tick(DeltaTime);
+
+  // Walk backwards so finished tweens can be swapped out in place.
+  for (int32 i = LerpAlphaTweens.Num() - 1; i >= 0; --i)
+  {
+    FUNLerpAlphaTween& Tween = LerpAlphaTweens[i];
+
+    // Binding the alpha to a collection scalar takes over from any tween already running.
+    UUNImage* Image = Tween.Target.Get();
+    if (!Image || Image->IsCollectionLerpAlphaBound())
+    {
+      LerpAlphaTweens.RemoveAtSwap(i, 1, false);
+      continue;
+    }
+
+    Tween.Elapsed += DeltaTime;
+
+    if (Tween.Elapsed >= Tween.Duration)
+    {
+      const float EndAlpha = Tween.EndAlpha;
+      LerpAlphaTweens.RemoveAtSwap(i, 1, false);
+      Image->SetCollectionLerpAlpha(EndAlpha);
+      continue;
+    }
+
+    const float Progress = EvaluateEasing(Tween.Easing, Tween.Elapsed / Tween.Duration, Tween.EasingExponent);
+    Image->SetCollectionLerpAlpha(FMath::Lerp(Tween.StartAlpha, Tween.EndAlpha, Progress));
+  }
+}
+
+bool UUNTweenSubsystem::IsTickable() const
+{
+  return !LerpAlphaTweens.IsEmpty();
+}
+
+TStatId UUNTweenSubsystem::GetStatId() const
+{
+  RETURN_QUICK_DECLARE_CYCLE_STAT(UUNTweenSubsystem, STATGROUP_Tickables);
+}
+
+void UUNTweenSubsystem::Deinitialize()
+{
+  LerpAlphaTweens.Empty();
+
+  Super::Deinitialize();
+}
+
+UUNTweenSubsystem* UUNTweenSubsystem::Get(const UWorld* World)
+{
+  return World ? World->GetSubsystem<UUNTweenSubsystem>() : nullptr;
+}
+
+void UUNTweenSubsystem::TweenLerpAlpha(UUNImage* Image, float TargetAlpha, float Duration, EUNTweenEasing Easing, float EasingExponent)
+{
+  if (!Image)
+    return;
+
+  StopLerpAlphaTween(Image);
+
+  if (Duration <= 0.0f)
+  {
+    Image->SetCollectionLerpAlpha(TargetAlpha);
+    return;
+  }
+
+  FUNLerpAlphaTween& Tween = LerpAlphaTweens.AddDefaulted_GetRef();
+  Tween.Target = Image;
+  Tween.StartAlpha = Image->GetCollectionLerpAlpha();
+  Tween.EndAlpha = TargetAlpha;
+  Tween.Duration = Duration;
+  Tween.Elapsed = 0.0f;
+  Tween.EasingExponent = EasingExponent;
+  Tween.Easing = Easing;
+}
+
+void UUNTweenSubsystem::StopLerpAlphaTween(const UUNImage* Image)
+{
+  const int32 Index = LerpAlphaTweens.IndexOfByPredicate([Image](const FUNLerpAlphaTween& Tween) { return Tween.Target.Get() == Image; });
+  if (Index != INDEX_NONE)
+    LerpAlphaTweens.RemoveAtSwap(Index, 1, false);
+}
+
+bool UUNTweenSubsystem::IsTweeningLerpAlpha(const UUNImage* Image) const
+{
+  return LerpAlphaTweens.ContainsByPredicate([Image](const FUNLerpAlphaTween& Tween) { return Tween.Target.Get() == Image; });
+}
+
+float UUNTweenSubsystem::EvaluateEasing(EUNTweenEasing Easing, float Alpha, float Exponent)
+{
+  switch (Easing)
+  {
+    case EUNTweenEasing::EaseIn:
+      return FMath::InterpEaseIn(0.0f, 1.0f, Alpha, Exponent);
+    case EUNTweenEasing::EaseOut:
+      return FMath::InterpEaseOut(0.0f, 1.0f, Alpha, Exponent);
+    case EUNTweenEasing::EaseInOut:
+      return FMath::InterpEaseInOut(0.0f, 1.0f, Alpha, Exponent);
+    case EUNTweenEasing::Linear:
+    default:
+      return Alpha;
+  }
+}
\ No newline at end of file
@@ -0,0 +1,117 @@
+﻿// "Copyright (C) Craig Williams, SlashParadox"
+
+#pragma once
+
+#include "Subsystems/WorldSubsystem.h"
+
+#include "UNTweenSubsystem.generated.h"
+
+class UUNImage;
+
+/**
+ * @enum EUNTweenEasing
+ * @brief The easing curve applied over a tween's duration.
+ */
+UENUM(BlueprintType)
+enum class EUNTweenEasing : uint8
+{
+  Linear,
+  EaseIn,
+  EaseOut,
+  EaseInOut
+};
+
+/**
+ * @struct FUNLerpAlphaTween
+ * @brief A single active tween of a UUNImage's CollectionLerpAlpha.
+ */
+struct FUNLerpAlphaTween
+{
+  // The image being tweened.
+  TWeakObjectPtr<UUNImage> Target;
+
+  // The lerp alpha at the start of the tween.
+  float StartAlpha;
+
+  // The lerp alpha at the end of the tween.
+  float EndAlpha;
+
+  // The total length of the tween, in seconds.
+  float Duration;
+
+  // The time passed since the tween started, in seconds.
+  float Elapsed;
+
+  // The exponent of the easing curve. Unused for linear tweens.
+  float EasingExponent;
+
+  // The easing curve of the tween.
+  EUNTweenEasing Easing;
+};
+
+/**
+ * @class UUNTweenSubsystem
+ * @brief Drives native tweens of UUNImage lerp alphas from a single tick per world. The subsystem does not
+ * tick at all while no tweens are active.
+ */
+UCLASS()
+class UNIQ_API UUNTweenSubsystem : public UTickableWorldSubsystem
+{
+  GENERATED_BODY()
+
+public:
+  // Begin FTickableGameObject Interface
+  virtual void Tick(float DeltaTime) override;
+  virtual bool IsTickable() const override;
+  virtual bool IsTickableWhenPaused() const override { return true; }
+  virtual TStatId GetStatId() const override;
+  // End FTickableGameObject Interface
+
+  // Begin USubsystem Interface
+  virtual void Deinitialize() override;
+  // End USubsystem Interface
+
+  /**
+   * Gets the tween subsystem for a world.
+   * @param World The world to get the subsystem of.
+   * @returns Returns the subsystem, if available.
+   */
+  static UUNTweenSubsystem* Get(const UWorld* World);
+
+  /**
+   * Starts tweening an image's CollectionLerpAlpha from its current value. Replaces any tween already on the image.
+   * @param Image The image to tween.
+   * @param TargetAlpha The lerp alpha to end at.
+   * @param Duration The length of the tween, in seconds. If not positive, the alpha is set immediately.
+   * @param Easing The easing curve to apply.
+   * @param EasingExponent The exponent of the easing curve. Unused for linear tweens.
+   */
+  void TweenLerpAlpha(UUNImage* Image, float TargetAlpha, float Duration, EUNTweenEasing Easing, float EasingExponent = 2.0f);
+
+  /**
+   * Stops an image's tween, leaving its CollectionLerpAlpha where it currently is.
+   * @param Image The image to stop tweening.
+   */
+  void StopLerpAlphaTween(const UUNImage* Image);
+
+  /**
+   * Checks if an image's CollectionLerpAlpha is being tweened.
+   * @param Image The image to check.
+   * @returns Returns true if the image has an active tween.
+   */
+  bool IsTweeningLerpAlpha(const UUNImage* Image) const;
+
+private:
+  /**
+   * Evaluates an easing curve.
+   * @param Easing The easing curve to evaluate.
+   * @param Alpha The linear progress through the tween, from 0 to 1.
+   * @param Exponent The exponent of the easing curve.
+   * @returns Returns the eased progress through the tween.
+   */
+  static float EvaluateEasing(EUNTweenEasing Easing, float Alpha, float Exponent);
+
+private:
+  // Every active tween, packed together for the tick.
+  TArray<FUNLerpAlphaTween> LerpAlphaTweens;
+};
\ No newline at end of file
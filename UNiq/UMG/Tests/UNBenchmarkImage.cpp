@@ -0,0 +1,27 @@
+﻿// "Copyright (C) Craig Williams, SlashParadox"
+
+#include "UNBenchmarkImage.h"
+
+UUNBenchmarkImage::UUNBenchmarkImage(const FObjectInitializer& ObjectInitializer)
+  : Super(ObjectInitializer)
+{
+#if WITH_DEV_AUTOMATION_TESTS
+  RecomputeCount = 0;
+#endif
+}
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+void UUNBenchmarkImage::OnCollectionColorEvaluated(const FLinearColor& Color)
+{
+  ++RecomputeCount;
+  Super::OnCollectionColorEvaluated(Color);
+}
+
+void UUNBenchmarkImage::CalculateCachedCollectionColor()
+{
+  ++RecomputeCount;
+  Super::CalculateCachedCollectionColor();
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,60 @@
+﻿// "Copyright (C) Craig Williams, SlashParadox"
+
+#pragma once
+
+#include "Blueprint/UserWidget.h"
+#include "UNImage.h"
+
+#include "UNBenchmarkImage.generated.h"
+
+/**
+ * @class UUNBenchmarkImage
+ * @brief A UUNImage that counts how often it recomputes its collection color. Only used by the UNiq benchmarks.
+ * Reflected classes can't be compiled out, so outside of automation builds this is an empty, unexported shell.
+ */
+UCLASS(Transient, HideDropdown, NotBlueprintable)
+class UUNBenchmarkImage : public UUNImage
+{
+  GENERATED_UCLASS_BODY()
+
+#if WITH_DEV_AUTOMATION_TESTS
+protected:
+  // Begin FUNCollectionListener Interface
+  virtual void OnCollectionColorEvaluated(const FLinearColor& Color) override;
+  // End FUNCollectionListener Interface
+
+  // Begin UUNImage Interface
+  virtual void CalculateCachedCollectionColor() override;
+  // End UUNImage Interface
+
+public:
+  /**
+   * Gets the number of collection color recomputes, whether by this image or by the color pool.
+   * @returns Returns the RecomputeCount.
+   */
+  int32 GetRecomputeCount() const { return RecomputeCount; }
+
+  /**
+   * Gets the slate widget of this image.
+   * @returns Returns the slate widget, if built.
+   */
+  TSharedPtr<SUNImage> GetUNImageWidget() const { return MyUNImage; }
+
+  /** Resets the RecomputeCount.*/
+  void ResetRecomputeCount() { RecomputeCount = 0; }
+
+private:
+  // The number of collection color recomputes since the last reset.
+  int32 RecomputeCount;
+#endif
+};
+
+/**
+ * @class UUNBenchmarkUserWidget
+ * @brief A bare, concrete UUserWidget to build benchmark widgets in. Only used by the UNiq benchmarks.
+ */
+UCLASS(Transient, HideDropdown, NotBlueprintable)
+class UUNBenchmarkUserWidget : public UUserWidget
+{
+  GENERATED_BODY()
+};
\ No newline at end of file
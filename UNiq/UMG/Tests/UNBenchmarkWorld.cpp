@@ -0,0 +1,34 @@
+﻿// "Copyright (C) Craig Williams, SlashParadox"
+
+#include "UNBenchmarkWorld.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Blueprint/WidgetTree.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+
+FUNBenchmarkWorld::FUNBenchmarkWorld(const TCHAR* BaseName)
+  : World(UWorld::CreateWorld(EWorldType::Game, false, MakeUniqueObjectName(GetTransientPackage(), UWorld::StaticClass(), BaseName)))
+{
+  FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+  WorldContext.SetCurrentWorld(World);
+
+  // UUserWidget itself is abstract, so a bare native subclass stands in. Initializing it creates its widget tree.
+  UserWidget.Reset(CreateWidget<UUNBenchmarkUserWidget>(World, UUNBenchmarkUserWidget::StaticClass()));
+  check(UserWidget.IsValid() && UserWidget->WidgetTree);
+}
+
+FUNBenchmarkWorld::~FUNBenchmarkWorld()
+{
+  UserWidget.Reset();
+  GEngine->DestroyWorldContext(World);
+  World->DestroyWorld(false);
+}
+
+UWidgetTree* FUNBenchmarkWorld::GetWidgetTree() const
+{
+  return UserWidget->WidgetTree;
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,53 @@
+﻿// "Copyright (C) Craig Williams, SlashParadox"
+
+#pragma once
+
+#include "Misc/Build.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "UNBenchmarkImage.h"
+#include "UObject/StrongObjectPtr.h"
+
+class UWidgetTree;
+class UWorld;
+
+/**
+ * @class FUNBenchmarkWorld
+ * @brief A fresh, headless game world with a user widget to build benchmark widgets in. Both are torn down when
+ * this goes out of scope, so release any widgets built in it first. Only used by the UNiq benchmarks and tests.
+ */
+class FUNBenchmarkWorld
+{
+public:
+  /**
+   * Creates the world and its user widget.
+   * @param BaseName The base name of the world.
+   */
+  explicit FUNBenchmarkWorld(const TCHAR* BaseName);
+
+  FUNBenchmarkWorld(const FUNBenchmarkWorld&) = delete;
+  FUNBenchmarkWorld& operator=(const FUNBenchmarkWorld&) = delete;
+  ~FUNBenchmarkWorld();
+
+  /**
+   * Gets the world.
+   * @returns Returns the world.
+   */
+  UWorld* GetWorld() const { return World; }
+
+  /**
+   * Gets the widget tree to construct benchmark widgets in. Widgets built in it are in the world.
+   * @returns Returns the widget tree.
+   */
+  UWidgetTree* GetWidgetTree() const;
+
+private:
+  // The benchmark world.
+  UWorld* World;
+
+  // The user widget holding the benchmark widgets.
+  TStrongObjectPtr<UUNBenchmarkUserWidget> UserWidget;
+};
+
+#endif
\ No newline at end of file
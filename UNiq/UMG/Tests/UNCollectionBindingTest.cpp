@@ -0,0 +1,154 @@
+﻿// "Copyright (C) Craig Williams, SlashParadox"
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Blueprint/UserWidget.h"
+#include "Blueprint/WidgetTree.h"
+#include "Components/TextBlock.h"
+#include "Engine/World.h"
+#include "Materials/MaterialParameterCollection.h"
+#include "Materials/MaterialParameterCollectionInstance.h"
+#include "UNBenchmarkImage.h"
+#include "UNBenchmarkWorld.h"
+#include "UNCollectionBindingExtension.h"
+#include "UNCollectionSubsystem.h"
+#include "UObject/StrongObjectPtr.h"
+
+namespace UNCollectionBindingTestPrivate
+{
+  // The names of the collection parameters the test binds to.
+  static const FName VectorParameterName(TEXT("BindingVector"));
+  static const FName ScalarParameterName(TEXT("BindingScalar"));
+
+  // The default values of the collection parameters.
+  static const FLinearColor DefaultVector(0.2f, 0.4f, 0.6f, 1.0f);
+  static constexpr float DefaultScalar = 0.25f;
+
+  /**
+   * Creates a transient collection with the bound vector and scalar parameters.
+   * @returns Returns the new collection.
+   */
+  static UMaterialParameterCollection* CreateCollection()
+  {
+    UMaterialParameterCollection* Collection = NewObject<UMaterialParameterCollection>(GetTransientPackage(), MakeUniqueObjectName(GetTransientPackage(), UMaterialParameterCollection::StaticClass(), TEXT("UNBindingTestCollection")), RF_Transient);
+
+    FCollectionVectorParameter& Vector = Collection->VectorParameters.AddDefaulted_GetRef();
+    Vector.ParameterName = VectorParameterName;
+    Vector.DefaultValue = DefaultVector;
+
+    FCollectionScalarParameter& Scalar = Collection->ScalarParameters.AddDefaulted_GetRef();
+    Scalar.ParameterName = ScalarParameterName;
+    Scalar.DefaultValue = DefaultScalar;
+
+    return Collection;
+  }
+
+  /**
+   * Reads a property of a widget through reflection, so protected and private properties can be checked too.
+   * @param Widget The widget to read.
+   * @param PropertyName The name of the property. Must exist, and be a T.
+   * @returns Returns the property's value.
+   */
+  template <typename T>
+  static const T& ReadProperty(const UWidget* Widget, const TCHAR* PropertyName)
+  {
+    const FProperty* Property = FindFProperty<FProperty>(Widget->GetClass(), PropertyName);
+    check(Property && Property->GetSize() == sizeof(T));
+    return *Property->ContainerPtrToValuePtr<T>(Widget);
+  }
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FUNCollectionBindingTest, "UNiq.UMG.CollectionBinding", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FUNCollectionBindingTest::RunTest(const FString& Parameters)
+{
+  using namespace UNCollectionBindingTestPrivate;
+
+  const FUNBenchmarkWorld BenchmarkWorld(TEXT("UNCollectionBindingTest"));
+  UWorld* World = BenchmarkWorld.GetWorld();
+  UWidgetTree* WidgetTree = BenchmarkWorld.GetWidgetTree();
+  UUserWidget* UserWidget = CastChecked<UUserWidget>(WidgetTree->GetOuter());
+
+  const TStrongObjectPtr<UMaterialParameterCollection> Collection(CreateCollection());
+  World->AddParameterCollectionInstance(Collection.Get(), false);
+  UMaterialParameterCollectionInstance* Instance = World->GetParameterCollectionInstance(Collection.Get());
+  UUNCollectionSubsystem* Subsystem = UUNCollectionSubsystem::Get(World);
+  if (!TestNotNull(TEXT("Collection instance"), Instance) || !TestNotNull(TEXT("Collection subsystem"), Subsystem))
+    return false;
+
+  const FUNParameterCollectionIndex VectorIndex(Collection.Get(), VectorParameterName);
+  const FUNParameterCollectionIndex ScalarIndex(Collection.Get(), ScalarParameterName);
+
+  const TStrongObjectPtr<UUNBenchmarkImage> SetterImage(WidgetTree->ConstructWidget<UUNBenchmarkImage>());
+  const TStrongObjectPtr<UTextBlock> PrefixedSetterText(WidgetTree->ConstructWidget<UTextBlock>());
+  const TStrongObjectPtr<UUNBenchmarkImage> PropertyImage(WidgetTree->ConstructWidget<UUNBenchmarkImage>());
+  const TStrongObjectPtr<UUNBenchmarkImage> ScalarImage(WidgetTree->ConstructWidget<UUNBenchmarkImage>());
+
+  // A function of the Target's own name is used first, then one with "Set" prefixed, then the property itself.
+  TestTrue(TEXT("Bound to an explicit setter"), UUNCollectionBindingExtension::BindWidgetToCollection(SetterImage.Get(), VectorIndex, EUNCollectionParameterType::Vector, TEXT("SetColorAndOpacity")));
+  TestTrue(TEXT("Bound to a prefixed setter"), UUNCollectionBindingExtension::BindWidgetToCollection(PrefixedSetterText.Get(), VectorIndex, EUNCollectionParameterType::Vector, TEXT("ColorAndOpacity")));
+  TestTrue(TEXT("Bound to a scalar setter"), UUNCollectionBindingExtension::BindWidgetToCollection(ScalarImage.Get(), ScalarIndex, EUNCollectionParameterType::Scalar, TEXT("CollectionLerpAlpha")));
+
+  AddExpectedError(TEXT("No setter found, so the property is set directly"), EAutomationExpectedErrorFlags::Contains, 1);
+  TestTrue(TEXT("Bound to a property"), UUNCollectionBindingExtension::BindWidgetToCollection(PropertyImage.Get(), VectorIndex, EUNCollectionParameterType::Vector, TEXT("AsyncPlaceholderColor")));
+
+  // A color can't take a scalar, and there is no property to fall back to.
+  AddExpectedError(TEXT("No setter or property found that takes the parameter"), EAutomationExpectedErrorFlags::Contains, 1);
+  TestFalse(TEXT("Bound a scalar to a color setter"), UUNCollectionBindingExtension::BindWidgetToCollection(SetterImage.Get(), ScalarIndex, EUNCollectionParameterType::Scalar, TEXT("SetColorAndOpacity")));
+
+  // Nothing is pushed until the user widget is constructed. Its slate widget is held, as dropping it destructs it.
+  TestFalse(TEXT("Pushed before construction"), ReadProperty<FLinearColor>(SetterImage.Get(), TEXT("ColorAndOpacity")).Equals(DefaultVector));
+  const TSharedRef<SWidget> UserSlateWidget = UserWidget->TakeWidget();
+
+  TestEqual(TEXT("Explicit setter took the vector as a linear color"), ReadProperty<FLinearColor>(SetterImage.Get(), TEXT("ColorAndOpacity")), DefaultVector);
+  TestEqual(TEXT("Prefixed setter took the vector as a slate color"), ReadProperty<FSlateColor>(PrefixedSetterText.Get(), TEXT("ColorAndOpacity")).GetSpecifiedColor(), DefaultVector);
+  TestEqual(TEXT("Property took the vector as a linear color"), ReadProperty<FLinearColor>(PropertyImage.Get(), TEXT("AsyncPlaceholderColor")), DefaultVector);
+  TestEqual(TEXT("Scalar setter took the scalar as a float"), ScalarImage->GetCollectionLerpAlpha(), DefaultScalar);
+
+  // A vector update pushes the vector bindings, and leaves the scalar binding alone.
+  const FLinearColor UpdatedVector(0.9f, 0.8f, 0.7f, 0.5f);
+  ScalarImage->ResetRecomputeCount();
+  Instance->SetVectorParameterValue(VectorParameterName, UpdatedVector);
+  Subsystem->FlushPendingUpdates();
+
+  TestEqual(TEXT("Explicit setter was pushed the update"), ReadProperty<FLinearColor>(SetterImage.Get(), TEXT("ColorAndOpacity")), UpdatedVector);
+  TestEqual(TEXT("Prefixed setter was pushed the update"), ReadProperty<FSlateColor>(PrefixedSetterText.Get(), TEXT("ColorAndOpacity")).GetSpecifiedColor(), UpdatedVector);
+  TestEqual(TEXT("Property was pushed the update"), ReadProperty<FLinearColor>(PropertyImage.Get(), TEXT("AsyncPlaceholderColor")), UpdatedVector);
+  TestEqual(TEXT("Unchanged scalar was pushed"), ScalarImage->GetRecomputeCount(), 0);
+
+  Instance->SetScalarParameterValue(ScalarParameterName, 0.75f);
+  Subsystem->FlushPendingUpdates();
+
+  TestEqual(TEXT("Scalar setter was pushed the update"), ScalarImage->GetCollectionLerpAlpha(), 0.75f);
+  TestEqual(TEXT("Scalar pushes per change"), ScalarImage->GetRecomputeCount(), 1);
+
+  // Both writes reach the collection, but only the last is dispatched, and it matches what was already pushed.
+  Subsystem->BeginUpdateTransaction();
+  Instance->SetScalarParameterValue(ScalarParameterName, 0.5f);
+  Instance->SetScalarParameterValue(ScalarParameterName, 0.75f);
+  Subsystem->EndUpdateTransaction();
+
+  TestEqual(TEXT("Scalar pushes after a round trip to the same value"), ScalarImage->GetRecomputeCount(), 1);
+
+  // Removing the extension unsubscribes every binding, and releases the parameter back out of the table.
+  UserWidget->RemoveExtension(UserWidget->GetExtension<UUNCollectionBindingExtension>());
+  TestEqual(TEXT("Vector parameter handle after removal"), Subsystem->GetParameterTable().Find(TObjectKey<UMaterialParameterCollectionInstance>(Instance), VectorParameterName), static_cast<int32>(INDEX_NONE));
+
+  Instance->SetVectorParameterValue(VectorParameterName, DefaultVector);
+  Instance->SetScalarParameterValue(ScalarParameterName, DefaultScalar);
+  Subsystem->FlushPendingUpdates();
+
+  TestEqual(TEXT("Vector pushed after removal"), ReadProperty<FLinearColor>(SetterImage.Get(), TEXT("ColorAndOpacity")), UpdatedVector);
+  TestEqual(TEXT("Scalar pushed after removal"), ScalarImage->GetCollectionLerpAlpha(), 0.75f);
+
+  for (UWidget* Widget : { static_cast<UWidget*>(SetterImage.Get()), static_cast<UWidget*>(PrefixedSetterText.Get()), static_cast<UWidget*>(PropertyImage.Get()), static_cast<UWidget*>(ScalarImage.Get()) })
+  {
+    Widget->ReleaseSlateResources(true);
+  }
+
+  return true;
+}
+
+#endif
\ No newline at end of file
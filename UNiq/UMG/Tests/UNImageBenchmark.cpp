@@ -0,0 +1,356 @@
+﻿// "Copyright (C) Craig Williams, SlashParadox"
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Blueprint/WidgetTree.h"
+#include "Engine/World.h"
+#include "Framework/Application/SlateApplication.h"
+#include "HAL/PlatformTime.h"
+#include "Input/HittestGrid.h"
+#include "Materials/MaterialParameterCollection.h"
+#include "Materials/MaterialParameterCollectionInstance.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Rendering/DrawElements.h"
+#include "Serialization/ArchiveCountMem.h"
+#include "SUNImage.h"
+#include "UNBenchmarkImage.h"
+#include "UNBenchmarkWorld.h"
+#include "UNCollectionSubsystem.h"
+#include "UNInterpContainer.h"
+#include "UObject/StrongObjectPtr.h"
+
+namespace UNImageBenchmarkPrivate
+{
+  // The names of the collection parameters the benchmark images are bound to.
+  static const FName PrimaryParameterName(TEXT("BenchmarkPrimary"));
+  static const FName SecondaryParameterName(TEXT("BenchmarkSecondary"));
+
+  // The number of parameter updates timed per run.
+  static constexpr int32 NumParameterUpdates = 64;
+
+  // The number of interp container value changes timed per run.
+  static constexpr int32 NumInterpUpdates = 10000;
+
+  /**
+   * @struct FResults
+   * @brief The measurements of a single benchmark run.
+   */
+  struct FResults
+  {
+    // The number of images in the run.
+    int32 NumImages = 0;
+
+    // The time to build every image's slate widget, in milliseconds.
+    double RebuildWidgetMs = 0.0;
+
+    // The average time for a single parameter update to reach every image, in milliseconds.
+    double ParameterUpdateMs = 0.0;
+
+    // The average number of collection color recomputes caused by a single parameter update.
+    double RecomputesPerUpdate = 0.0;
+
+    // The average time to paint a single image, in microseconds. Negative if slate is not initialized.
+    double PaintMicrosecondsPerImage = -1.0;
+
+    // The average memory of one image object, including everything its properties allocate, in bytes.
+    int64 ImageBytesPerImage = 0;
+
+    // The growth of the collection subsystem's allocated bindings, subscribers, parameters and pooled colors per
+    // image, in bytes.
+    int64 SubsystemBytesPerImage = 0;
+
+    // The growth of the interned parameter table per image, in bytes.
+    int64 ParameterTableBytesPerImage = 0;
+
+    // What the parameter table would grow by per image if each binding held its own copy, in bytes.
+    int64 UninternedParameterBytesPerImage = 0;
+
+    // The growth of the color pool per image, in bytes.
+    int64 ColorPoolBytesPerImage = 0;
+
+    // The growth of the bindings and subscriber lists per image, in bytes.
+    int64 SubscriberBytesPerImage = 0;
+
+    // The number of distinct colors the color pool evaluates for all of the images.
+    int32 NumPooledColors = 0;
+
+    // The average time for an interp container value change to reach a native listener, in microseconds.
+    double InterpUpdateMicroseconds = 0.0;
+  };
+
+  /**
+   * Converts the results of a run to JSON.
+   * @param Results The results to convert.
+   * @returns Returns a single JSON object.
+   */
+  static FString ToJson(const FResults& Results)
+  {
+    return FString::Printf(
+      TEXT("{\"NumImages\":%d,\"RebuildWidgetMs\":%.6f,\"ParameterUpdateMs\":%.6f,\"RecomputesPerUpdate\":%.3f,")
+      TEXT("\"PaintMicrosecondsPerImage\":%.6f,\"ImageBytesPerImage\":%lld,\"SubsystemBytesPerImage\":%lld,")
+      TEXT("\"ParameterTableBytesPerImage\":%lld,\"UninternedParameterBytesPerImage\":%lld,\"ColorPoolBytesPerImage\":%lld,")
+      TEXT("\"SubscriberBytesPerImage\":%lld,\"NumPooledColors\":%d,\"InterpUpdateMicroseconds\":%.6f}"),
+      Results.NumImages, Results.RebuildWidgetMs, Results.ParameterUpdateMs, Results.RecomputesPerUpdate,
+      Results.PaintMicrosecondsPerImage, Results.ImageBytesPerImage, Results.SubsystemBytesPerImage,
+      Results.ParameterTableBytesPerImage, Results.UninternedParameterBytesPerImage, Results.ColorPoolBytesPerImage,
+      Results.SubscriberBytesPerImage, Results.NumPooledColors, Results.InterpUpdateMicroseconds);
+  }
+
+  /**
+   * Creates a transient collection with the benchmark's primary and secondary parameters.
+   * @returns Returns the new collection.
+   */
+  static UMaterialParameterCollection* CreateCollection()
+  {
+    UMaterialParameterCollection* Collection = NewObject<UMaterialParameterCollection>(GetTransientPackage(), MakeUniqueObjectName(GetTransientPackage(), UMaterialParameterCollection::StaticClass(), TEXT("UNBenchmarkCollection")), RF_Transient);
+
+    FCollectionVectorParameter& Primary = Collection->VectorParameters.AddDefaulted_GetRef();
+    Primary.ParameterName = PrimaryParameterName;
+    Primary.DefaultValue = FLinearColor::White;
+
+    FCollectionVectorParameter& Secondary = Collection->VectorParameters.AddDefaulted_GetRef();
+    Secondary.ParameterName = SecondaryParameterName;
+    Secondary.DefaultValue = FLinearColor::Black;
+
+    return Collection;
+  }
+
+  /**
+   * Paints every image once, timing the whole pass.
+   * @param Images The images to paint.
+   * @returns Returns the average paint time per image, in microseconds. Negative if painting is unavailable.
+   */
+  static double MeasurePaint(const TArray<TStrongObjectPtr<UUNBenchmarkImage>>& Images)
+  {
+    if (!FSlateApplication::IsInitialized() || Images.IsEmpty())
+      return -1.0;
+
+    FSlateWindowElementList ElementList(nullptr);
+    FHittestGrid HittestGrid;
+    const FPaintArgs PaintArgs(nullptr, HittestGrid, FVector2D::ZeroVector, FPlatformTime::Seconds(), 0.0f);
+    const FGeometry Geometry = FGeometry::MakeRoot(FVector2D(32.0f, 32.0f), FSlateLayoutTransform());
+    const FSlateRect CullingRect(0.0f, 0.0f, 32.0f, 32.0f);
+    const FWidgetStyle WidgetStyle;
+
+    const double StartTime = FPlatformTime::Seconds();
+
+    for (const TStrongObjectPtr<UUNBenchmarkImage>& Image : Images)
+    {
+      if (const TSharedPtr<SUNImage> Widget = Image->GetUNImageWidget())
+        Widget->OnPaint(PaintArgs, Geometry, CullingRect, ElementList, 0, WidgetStyle, true);
+    }
+
+    return (FPlatformTime::Seconds() - StartTime) * 1000000.0 / static_cast<double>(Images.Num());
+  }
+
+  /**
+   * Times interp container value changes reaching a native listener.
+   * @param Outer The outer to create the container in.
+   * @returns Returns the average time per change, in microseconds.
+   */
+  static double MeasureInterpContainer(UObject* Outer)
+  {
+    const TStrongObjectPtr<UUNInterpContainer> Container(NewObject<UUNInterpContainer>(Outer, NAME_None, RF_Transient));
+
+    float Received = 0.0f;
+    Container->OnFloatValueChangedNative.AddLambda([&Received](float Value) { Received = Value; });
+
+    const double StartTime = FPlatformTime::Seconds();
+
+    for (int32 i = 1; i <= NumInterpUpdates; ++i)
+    {
+      Container->SetFloatValue(static_cast<float>(i));
+    }
+
+    const double ElapsedTime = FPlatformTime::Seconds() - StartTime;
+    ensure(Received == static_cast<float>(NumInterpUpdates));
+
+    return ElapsedTime * 1000000.0 / static_cast<double>(NumInterpUpdates);
+  }
+
+  /**
+   * @struct FSubsystemBytes
+   * @brief The memory the collection subsystem has allocated at one point of a run.
+   */
+  struct FSubsystemBytes
+  {
+    FSubsystemBytes() = default;
+
+    explicit FSubsystemBytes(const UUNCollectionSubsystem* Subsystem)
+    {
+      if (!Subsystem)
+        return;
+
+      Total = static_cast<int64>(Subsystem->GetAllocatedSize());
+      ParameterTable = static_cast<int64>(Subsystem->GetParameterTable().GetAllocatedSize());
+      UninternedParameters = static_cast<int64>(Subsystem->GetParameterTable().GetUninternedSize());
+      ColorPool = static_cast<int64>(Subsystem->GetColorPool().GetAllocatedSize());
+    }
+
+    // Everything the subsystem allocates to bind listeners.
+    int64 Total = 0;
+
+    // The interned parameter table.
+    int64 ParameterTable = 0;
+
+    // The parameter table, if each reference held its own copy.
+    int64 UninternedParameters = 0;
+
+    // The color pool.
+    int64 ColorPool = 0;
+  };
+
+  /**
+   * Measures the average memory of an image object, counting what its properties allocate on the heap.
+   * @param Images The images to measure.
+   * @returns Returns the average size per image, in bytes.
+   */
+  static int64 MeasureImageBytes(const TArray<TStrongObjectPtr<UUNBenchmarkImage>>& Images)
+  {
+    if (Images.IsEmpty())
+      return 0;
+
+    int64 TotalBytes = 0;
+    for (const TStrongObjectPtr<UUNBenchmarkImage>& Image : Images)
+    {
+      FArchiveCountMem CountMem(Image.Get());
+      TotalBytes += Image->GetClass()->GetStructureSize() + static_cast<int64>(CountMem.GetMax());
+    }
+
+    return TotalBytes / Images.Num();
+  }
+
+  /**
+   * Runs the benchmark in a fresh game world.
+   * @param NumImages The number of images to build.
+   * @returns Returns the measurements.
+   */
+  static FResults RunBenchmark(int32 NumImages)
+  {
+    FResults Results;
+    Results.NumImages = NumImages;
+
+    const FUNBenchmarkWorld BenchmarkWorld(TEXT("UNImageBenchmark"));
+    UWorld* World = BenchmarkWorld.GetWorld();
+
+    const TStrongObjectPtr<UMaterialParameterCollection> Collection(CreateCollection());
+    World->AddParameterCollectionInstance(Collection.Get(), false);
+    UMaterialParameterCollectionInstance* Instance = World->GetParameterCollectionInstance(Collection.Get());
+    check(Instance);
+
+    // The subsystem's allocations are counted directly, so allocator noise elsewhere in the process doesn't show up.
+    UUNCollectionSubsystem* Subsystem = UUNCollectionSubsystem::Get(World);
+    const FSubsystemBytes StartBytes(Subsystem);
+
+    TArray<TStrongObjectPtr<UUNBenchmarkImage>> Images;
+    Images.Reserve(NumImages);
+
+    for (int32 i = 0; i < NumImages; ++i)
+    {
+      Images.Emplace(BenchmarkWorld.GetWidgetTree()->ConstructWidget<UUNBenchmarkImage>());
+    }
+
+    // Rebuilding covers binding the color data, and building and initializing the slate widget.
+    const double RebuildStartTime = FPlatformTime::Seconds();
+
+    for (int32 i = 0; i < NumImages; ++i)
+    {
+      UUNBenchmarkImage* Image = Images[i].Get();
+      Image->SetCollectionColorIndex(FUNParameterCollectionIndex(Collection.Get(), PrimaryParameterName), true);
+      Image->SetCollectionColorIndex(FUNParameterCollectionIndex(Collection.Get(), SecondaryParameterName), false);
+      Image->SetCollectionLerpAlpha(static_cast<float>(i % 100) / 100.0f);
+      Image->TakeWidget();
+    }
+
+    Results.RebuildWidgetMs = (FPlatformTime::Seconds() - RebuildStartTime) * 1000.0;
+
+    const FSubsystemBytes EndBytes(Subsystem);
+    Results.SubsystemBytesPerImage = (EndBytes.Total - StartBytes.Total) / NumImages;
+    Results.ParameterTableBytesPerImage = (EndBytes.ParameterTable - StartBytes.ParameterTable) / NumImages;
+    Results.UninternedParameterBytesPerImage = (EndBytes.UninternedParameters - StartBytes.UninternedParameters) / NumImages;
+    Results.ColorPoolBytesPerImage = (EndBytes.ColorPool - StartBytes.ColorPool) / NumImages;
+    Results.SubscriberBytesPerImage = Results.SubsystemBytesPerImage - Results.ParameterTableBytesPerImage - Results.ColorPoolBytesPerImage;
+    Results.ImageBytesPerImage = MeasureImageBytes(Images);
+
+    for (const TStrongObjectPtr<UUNBenchmarkImage>& Image : Images)
+    {
+      Image->ResetRecomputeCount();
+    }
+
+    // Each update is a new value, so no image can skip it as unchanged.
+    Results.NumPooledColors = Subsystem ? Subsystem->GetNumPooledColors() : 0;
+    const double UpdateStartTime = FPlatformTime::Seconds();
+
+    for (int32 i = 0; i < NumParameterUpdates; ++i)
+    {
+      const float Value = static_cast<float>(i + 1) / static_cast<float>(NumParameterUpdates);
+      Instance->SetVectorParameterValue(PrimaryParameterName, FLinearColor(Value, 1.0f - Value, 0.5f, 1.0f));
+
+      if (Subsystem)
+        Subsystem->FlushPendingUpdates();
+    }
+
+    Results.ParameterUpdateMs = (FPlatformTime::Seconds() - UpdateStartTime) * 1000.0 / static_cast<double>(NumParameterUpdates);
+
+    int64 TotalRecomputes = 0;
+    for (const TStrongObjectPtr<UUNBenchmarkImage>& Image : Images)
+    {
+      TotalRecomputes += Image->GetRecomputeCount();
+    }
+
+    Results.RecomputesPerUpdate = static_cast<double>(TotalRecomputes) / static_cast<double>(NumParameterUpdates);
+    Results.PaintMicrosecondsPerImage = MeasurePaint(Images);
+    Results.InterpUpdateMicroseconds = MeasureInterpContainer(BenchmarkWorld.GetWidgetTree());
+
+    for (const TStrongObjectPtr<UUNBenchmarkImage>& Image : Images)
+    {
+      Image->ReleaseSlateResources(true);
+    }
+
+    Images.Empty();
+    return Results;
+  }
+}
+
+IMPLEMENT_COMPLEX_AUTOMATION_TEST(FUNImageBenchmarkTest, "UNiq.UMG.Benchmark.Image", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+void FUNImageBenchmarkTest::GetTests(TArray<FString>& OutBeautifiedNames, TArray<FString>& OutTestCommands) const
+{
+  for (const int32 NumImages : { 10, 1000, 10000 })
+  {
+    OutBeautifiedNames.Add(FString::Printf(TEXT("%d Images"), NumImages));
+    OutTestCommands.Add(FString::FromInt(NumImages));
+  }
+}
+
+bool FUNImageBenchmarkTest::RunTest(const FString& Parameters)
+{
+  using namespace UNImageBenchmarkPrivate;
+
+  const int32 NumImages = FCString::Atoi(*Parameters);
+  if (!TestTrue(TEXT("Image count is positive"), NumImages > 0))
+    return false;
+
+  const FResults Results = RunBenchmark(NumImages);
+  const FString Json = ToJson(Results);
+
+  // Every image must have seen every update, or the fan-out timing is meaningless.
+  TestTrue(TEXT("Every image recomputed on every update"), Results.RecomputesPerUpdate >= static_cast<double>(NumImages));
+
+  // Every image binds the same two parameters, so past a handful of images the table should cost next to nothing.
+  if (NumImages >= 1000)
+    TestTrue(TEXT("Interned parameters are smaller than one copy per image"), Results.ParameterTableBytesPerImage < Results.UninternedParameterBytesPerImage);
+
+  AddInfo(FString::Printf(TEXT("UNImageBenchmark %s"), *Json));
+
+  const FString OutputPath = FPaths::Combine(FPaths::AutomationDir(), TEXT("UNiq"), FString::Printf(TEXT("UNImageBenchmark_%d.json"), NumImages));
+  if (!FFileHelper::SaveStringToFile(Json, *OutputPath))
+    AddWarning(FString::Printf(TEXT("Unable to write results! Path: [%s]"), *OutputPath));
+
+  return true;
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,166 @@
+﻿// "Copyright (C) Craig Williams, SlashParadox"
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Blueprint/WidgetTree.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "UNBenchmarkImage.h"
+#include "UNBenchmarkWorld.h"
+#include "UNInterpContainer.h"
+#include "UNUpdateRecording.h"
+#include "UObject/StrongObjectPtr.h"
+
+namespace UNReplayBenchmarkPrivate
+{
+  /**
+   * Gets the directory the benchmarked recordings are read from.
+   * @returns Returns the directory.
+   */
+  static FString GetRecordingDir()
+  {
+    return FPaths::Combine(FPaths::AutomationDir(), TEXT("UNiq"), TEXT("Recordings"));
+  }
+
+  /**
+   * @struct FResults
+   * @brief The measurements of replaying a single recording.
+   */
+  struct FResults
+  {
+    // The number of updates in the recording, not counting frame markers.
+    int32 NumUpdates = 0;
+
+    // The number of updates that found their target and were applied.
+    int32 NumApplied = 0;
+
+    // The number of recorded frames with updates.
+    int32 NumFrames = 0;
+
+    // The length of the recording, in seconds.
+    double RecordedSeconds = 0.0;
+
+    // The time to replay the whole recording at full speed, in milliseconds.
+    double ReplayMs = 0.0;
+
+    // The average time to replay a single recorded frame, in milliseconds.
+    double ReplayMsPerFrame = 0.0;
+  };
+
+  /**
+   * Converts the results of a replay to JSON.
+   * @param Results The results to convert.
+   * @returns Returns a single JSON object.
+   */
+  static FString ToJson(const FResults& Results)
+  {
+    return FString::Printf(
+      TEXT("{\"NumUpdates\":%d,\"NumApplied\":%d,\"NumFrames\":%d,\"RecordedSeconds\":%.6f,\"ReplayMs\":%.6f,\"ReplayMsPerFrame\":%.6f}"),
+      Results.NumUpdates, Results.NumApplied, Results.NumFrames, Results.RecordedSeconds, Results.ReplayMs, Results.ReplayMsPerFrame);
+  }
+
+  /**
+   * Replays a recording at full speed into a fresh headless world. Every recorded widget is stood in for by a
+   * new widget of the same kind, since the recorded ones only exist in the session they were recorded in.
+   * @param Replay The loaded recording.
+   * @returns Returns the measurements.
+   */
+  static FResults RunReplay(FUNUpdateReplay& Replay)
+  {
+    FResults Results;
+    Results.NumFrames = Replay.GetNumFrames();
+    Results.RecordedSeconds = Replay.GetDuration();
+
+    const FUNBenchmarkWorld BenchmarkWorld(TEXT("UNReplayBenchmark"));
+
+    // Stand-ins are built up front, so building them isn't timed.
+    TMap<FString, TStrongObjectPtr<UWidget>> StandIns;
+    const TArray<FString>& Names = Replay.GetNames();
+
+    for (const FUNRecordedUpdate& Update : Replay.GetUpdates())
+    {
+      if (Update.Type == EUNRecordedUpdateType::Frame)
+        continue;
+
+      ++Results.NumUpdates;
+
+      if (Update.Type == EUNRecordedUpdateType::CollectionVector || Update.Type == EUNRecordedUpdateType::CollectionScalar)
+        continue;
+
+      const FString& Path = Names[Update.TargetIndex];
+      if (StandIns.Contains(Path))
+        continue;
+
+      UWidget* StandIn = nullptr;
+      if (Update.Type == EUNRecordedUpdateType::ImageLerpAlpha)
+        StandIn = BenchmarkWorld.GetWidgetTree()->ConstructWidget<UUNBenchmarkImage>();
+      else
+        StandIn = BenchmarkWorld.GetWidgetTree()->ConstructWidget<UUNInterpContainer>();
+
+      StandIn->TakeWidget();
+      StandIns.Emplace(Path, StandIn);
+    }
+
+    Replay.SetWidgetResolver([&StandIns](const FString& Path) -> UObject*
+    {
+      const TStrongObjectPtr<UWidget>* StandIn = StandIns.Find(Path);
+      return StandIn ? StandIn->Get() : nullptr;
+    });
+
+    const double StartTime = FPlatformTime::Seconds();
+    Results.NumApplied = Replay.ReplayAll(BenchmarkWorld.GetWorld());
+    Results.ReplayMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+    Results.ReplayMsPerFrame = Results.NumFrames > 0 ? Results.ReplayMs / static_cast<double>(Results.NumFrames) : 0.0;
+
+    for (const TPair<FString, TStrongObjectPtr<UWidget>>& StandIn : StandIns)
+    {
+      StandIn.Value->ReleaseSlateResources(true);
+    }
+
+    StandIns.Empty();
+    return Results;
+  }
+}
+
+IMPLEMENT_COMPLEX_AUTOMATION_TEST(FUNReplayBenchmarkTest, "UNiq.UMG.Benchmark.Replay", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+void FUNReplayBenchmarkTest::GetTests(TArray<FString>& OutBeautifiedNames, TArray<FString>& OutTestCommands) const
+{
+  using namespace UNReplayBenchmarkPrivate;
+
+  // Record with UN.Recording.Start and UN.Recording.Stop, then copy the file here for CI to pick up.
+  TArray<FString> FileNames;
+  IFileManager::Get().FindFiles(FileNames, *FPaths::Combine(GetRecordingDir(), TEXT("*.unrec")), true, false);
+
+  for (const FString& FileName : FileNames)
+  {
+    OutBeautifiedNames.Add(FPaths::GetBaseFilename(FileName));
+    OutTestCommands.Add(FPaths::Combine(GetRecordingDir(), FileName));
+  }
+}
+
+bool FUNReplayBenchmarkTest::RunTest(const FString& Parameters)
+{
+  using namespace UNReplayBenchmarkPrivate;
+
+  FUNUpdateReplay Replay;
+  if (!TestTrue(TEXT("Recording loaded"), Replay.Load(Parameters)))
+    return false;
+
+  const FResults Results = RunReplay(Replay);
+  const FString Json = ToJson(Results);
+
+  AddInfo(FString::Printf(TEXT("UNReplayBenchmark %s"), *Json));
+
+  const FString OutputPath = FPaths::Combine(FPaths::AutomationDir(), TEXT("UNiq"), FString::Printf(TEXT("UNReplayBenchmark_%s.json"), *FPaths::GetBaseFilename(Parameters)));
+  if (!FFileHelper::SaveStringToFile(Json, *OutputPath))
+    AddWarning(FString::Printf(TEXT("Unable to write results! Path: [%s]"), *OutputPath));
+
+  return true;
+}
+
+#endif
\ No newline at end of file
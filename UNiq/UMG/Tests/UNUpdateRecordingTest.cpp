@@ -0,0 +1,223 @@
+﻿// "Copyright (C) Craig Williams, SlashParadox"
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Blueprint/WidgetTree.h"
+#include "Engine/World.h"
+#include "HAL/FileManager.h"
+#include "Materials/MaterialParameterCollection.h"
+#include "Materials/MaterialParameterCollectionInstance.h"
+#include "Misc/CoreDelegates.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "UNBenchmarkImage.h"
+#include "UNBenchmarkWorld.h"
+#include "UNInterpContainer.h"
+#include "UNUpdateRecording.h"
+#include "UObject/StrongObjectPtr.h"
+
+namespace UNUpdateRecordingTestPrivate
+{
+  // The names of the collection parameters the test records.
+  static const FName VectorParameterName(TEXT("RecordedVector"));
+  static const FName ScalarParameterName(TEXT("RecordedScalar"));
+
+  /**
+   * @struct FExpectedUpdate
+   * @brief An update the loaded recording should hold, in terms of what was set rather than name indices.
+   */
+  struct FExpectedUpdate
+  {
+    // The kind of update.
+    EUNRecordedUpdateType Type = EUNRecordedUpdateType::Frame;
+
+    // The collection or widget path that was updated. Empty for frame markers.
+    FString Target;
+
+    // The collection parameter that was updated. Empty for widgets and frame markers.
+    FString Parameter;
+
+    // The value that was set, packed the way the recording packs it.
+    FLinearColor Value = FLinearColor(ForceInitToZero);
+  };
+
+  /**
+   * Gets the directory the test writes its recordings to.
+   * @returns Returns the directory.
+   */
+  static FString GetRecordingDir()
+  {
+    return FPaths::Combine(FPaths::AutomationDir(), TEXT("UNiq"), TEXT("RecordingTest"));
+  }
+
+  /**
+   * Creates a transient collection with the recorded vector and scalar parameters.
+   * @returns Returns the new collection.
+   */
+  static UMaterialParameterCollection* CreateCollection()
+  {
+    UMaterialParameterCollection* Collection = NewObject<UMaterialParameterCollection>(GetTransientPackage(), MakeUniqueObjectName(GetTransientPackage(), UMaterialParameterCollection::StaticClass(), TEXT("UNRecordingTestCollection")), RF_Transient);
+
+    FCollectionVectorParameter& Vector = Collection->VectorParameters.AddDefaulted_GetRef();
+    Vector.ParameterName = VectorParameterName;
+    Vector.DefaultValue = FLinearColor::White;
+
+    FCollectionScalarParameter& Scalar = Collection->ScalarParameters.AddDefaulted_GetRef();
+    Scalar.ParameterName = ScalarParameterName;
+    Scalar.DefaultValue = 0.0f;
+
+    return Collection;
+  }
+
+  /**
+   * Adds an expected update.
+   * @param Expected The expected updates to add to.
+   * @param Type The kind of update.
+   * @param Target The path of the updated collection or widget.
+   * @param Parameter The name of the updated collection parameter, if any.
+   * @param Value The value that was set.
+   */
+  static void Expect(TArray<FExpectedUpdate>& Expected, EUNRecordedUpdateType Type, const FString& Target, const FString& Parameter, const FLinearColor& Value)
+  {
+    FExpectedUpdate& Update = Expected.AddDefaulted_GetRef();
+    Update.Type = Type;
+    Update.Target = Target;
+    Update.Parameter = Parameter;
+    Update.Value = Value;
+  }
+
+  /**
+   * Records two frames of every kind of update into a fresh headless world.
+   * @param Path The file to write the recording to.
+   * @param OutExpected The updates the recording should hold, in order.
+   * @returns Returns true if the recording was started and written.
+   */
+  static bool Record(const FString& Path, TArray<FExpectedUpdate>& OutExpected)
+  {
+    const FUNBenchmarkWorld BenchmarkWorld(TEXT("UNRecordingTest"));
+    UWorld* World = BenchmarkWorld.GetWorld();
+
+    const TStrongObjectPtr<UMaterialParameterCollection> Collection(CreateCollection());
+    World->AddParameterCollectionInstance(Collection.Get(), false);
+    UMaterialParameterCollectionInstance* Instance = World->GetParameterCollectionInstance(Collection.Get());
+    check(Instance);
+
+    const TStrongObjectPtr<UUNBenchmarkImage> Image(BenchmarkWorld.GetWidgetTree()->ConstructWidget<UUNBenchmarkImage>());
+    const TStrongObjectPtr<UUNInterpContainer> Container(BenchmarkWorld.GetWidgetTree()->ConstructWidget<UUNInterpContainer>());
+
+    // The recorder binds the world's collection instances when it starts, so the instance has to exist first.
+    if (!FUNUpdateRecorder::Start(World, Path))
+      return false;
+
+    const FString CollectionPath = Collection->GetPathName();
+    const FString ImagePath = Image->GetPathName();
+    const FString ContainerPath = Container->GetPathName();
+    const FLinearColor FirstColor(0.25f, 0.5f, 0.75f, 1.0f);
+    const FLinearColor SecondColor(0.1f, 0.2f, 0.3f, 0.4f);
+    const FLinearColor ContainerColor(1.0f, 0.0f, 0.5f, 0.25f);
+
+    Instance->SetVectorParameterValue(VectorParameterName, FirstColor);
+    Instance->SetScalarParameterValue(ScalarParameterName, 0.25f);
+    Image->SetCollectionLerpAlpha(0.5f);
+
+    Expect(OutExpected, EUNRecordedUpdateType::CollectionVector, CollectionPath, VectorParameterName.ToString(), FirstColor);
+    Expect(OutExpected, EUNRecordedUpdateType::CollectionScalar, CollectionPath, ScalarParameterName.ToString(), FLinearColor(0.25f, 0.0f, 0.0f, 0.0f));
+    Expect(OutExpected, EUNRecordedUpdateType::ImageLerpAlpha, ImagePath, FString(), FLinearColor(0.5f, 0.0f, 0.0f, 0.0f));
+
+    // The recorder closes a frame at the end of every engine frame, so end one by hand instead of waiting for it.
+    FCoreDelegates::OnEndFrame.Broadcast();
+    Expect(OutExpected, EUNRecordedUpdateType::Frame, FString(), FString(), FLinearColor(ForceInitToZero));
+
+    Container->SetFloatValue(3.5f);
+    Container->SetVector2DValue(FVector2D(1.5f, -2.0f));
+    Container->SetColorValue(ContainerColor);
+    Instance->SetVectorParameterValue(VectorParameterName, SecondColor);
+
+    Expect(OutExpected, EUNRecordedUpdateType::InterpFloat, ContainerPath, FString(), FLinearColor(3.5f, 0.0f, 0.0f, 0.0f));
+    Expect(OutExpected, EUNRecordedUpdateType::InterpVector2D, ContainerPath, FString(), FLinearColor(1.5f, -2.0f, 0.0f, 0.0f));
+    Expect(OutExpected, EUNRecordedUpdateType::InterpColor, ContainerPath, FString(), ContainerColor);
+    Expect(OutExpected, EUNRecordedUpdateType::CollectionVector, CollectionPath, VectorParameterName.ToString(), SecondColor);
+
+    // Stopping closes off the last frame.
+    const bool bWritten = FUNUpdateRecorder::Stop();
+    Expect(OutExpected, EUNRecordedUpdateType::Frame, FString(), FString(), FLinearColor(ForceInitToZero));
+
+    return bWritten;
+  }
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FUNUpdateRecordingRoundTripTest, "UNiq.UMG.Recording.RoundTrip", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FUNUpdateRecordingRoundTripTest::RunTest(const FString& Parameters)
+{
+  using namespace UNUpdateRecordingTestPrivate;
+
+  const FString Path = FPaths::Combine(GetRecordingDir(), TEXT("RoundTrip.unrec"));
+  const FString TruncatedPath = FPaths::Combine(GetRecordingDir(), TEXT("Truncated.unrec"));
+  const FString BadVersionPath = FPaths::Combine(GetRecordingDir(), TEXT("BadVersion.unrec"));
+
+  TArray<FExpectedUpdate> Expected;
+  if (!TestTrue(TEXT("Recording written"), Record(Path, Expected)))
+    return false;
+
+  FUNUpdateReplay Replay;
+  if (!TestTrue(TEXT("Recording loaded"), Replay.Load(Path)))
+    return false;
+
+  const TArray<FUNRecordedUpdate>& Updates = Replay.GetUpdates();
+  const TArray<FString>& Names = Replay.GetNames();
+
+  TestEqual(TEXT("Frame count"), Replay.GetNumFrames(), 2);
+
+  if (TestEqual(TEXT("Update count"), Updates.Num(), Expected.Num()))
+  {
+    for (int32 i = 0; i < Updates.Num(); ++i)
+    {
+      const FUNRecordedUpdate& Update = Updates[i];
+      const FExpectedUpdate& ExpectedUpdate = Expected[i];
+
+      TestEqual(*FString::Printf(TEXT("Update [%d] type"), i), static_cast<int32>(Update.Type), static_cast<int32>(ExpectedUpdate.Type));
+      TestEqual(*FString::Printf(TEXT("Update [%d] value"), i), Update.Value, ExpectedUpdate.Value);
+
+      // Times are deltas from the previous update, so they can never run backwards.
+      if (i > 0)
+        TestTrue(*FString::Printf(TEXT("Update [%d] is in order"), i), Update.Time >= Updates[i - 1].Time);
+
+      const FString Target = Names.IsValidIndex(Update.TargetIndex) ? Names[Update.TargetIndex] : FString();
+      const FString Parameter = Names.IsValidIndex(Update.ParameterIndex) ? Names[Update.ParameterIndex] : FString();
+      TestEqual(*FString::Printf(TEXT("Update [%d] target"), i), Target, ExpectedUpdate.Target);
+      TestEqual(*FString::Printf(TEXT("Update [%d] parameter"), i), Parameter, ExpectedUpdate.Parameter);
+    }
+  }
+
+  TArray<uint8> Data;
+  if (!TestTrue(TEXT("Recording read back"), FFileHelper::LoadFileToArray(Data, *Path)))
+    return false;
+
+  // The last update is a frame marker of at least two bytes, so dropping one byte always cuts an update short.
+  TArray<uint8> Truncated(Data.GetData(), Data.Num() - 1);
+  FFileHelper::SaveArrayToFile(Truncated, *TruncatedPath);
+
+  AddExpectedError(TEXT("Recording is corrupt!"), EAutomationExpectedErrorFlags::Contains, 1);
+  TestFalse(TEXT("Truncated recording loaded"), Replay.Load(TruncatedPath));
+  TestEqual(TEXT("Truncated recording left no updates"), Replay.GetUpdates().Num(), 0);
+
+  // The version follows the four byte magic.
+  TArray<uint8> BadVersion = Data;
+  uint32 Version = 0;
+  FMemory::Memcpy(&Version, BadVersion.GetData() + sizeof(uint32), sizeof(uint32));
+  ++Version;
+  FMemory::Memcpy(BadVersion.GetData() + sizeof(uint32), &Version, sizeof(uint32));
+  FFileHelper::SaveArrayToFile(BadVersion, *BadVersionPath);
+
+  AddExpectedError(TEXT("Not a recording of a supported version!"), EAutomationExpectedErrorFlags::Contains, 1);
+  TestFalse(TEXT("Recording of a newer version loaded"), Replay.Load(BadVersionPath));
+  TestEqual(TEXT("Recording of a newer version left no updates"), Replay.GetUpdates().Num(), 0);
+
+  IFileManager::Get().DeleteDirectory(*GetRecordingDir(), false, true);
+  return true;
+}
+
+#endif
\ No newline at end of file
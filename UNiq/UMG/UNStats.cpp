@@ -0,0 +1,18 @@
+﻿// "Copyright (C) Craig Williams, SlashParadox"
+
+#include "UNStats.h"
+
+DEFINE_STAT(STAT_UNiq_RebindColorData);
+DEFINE_STAT(STAT_UNiq_ResolveColorDataParameter);
+DEFINE_STAT(STAT_UNiq_OnVectorParameterUpdated);
+DEFINE_STAT(STAT_UNiq_OnScalarParameterUpdated);
+DEFINE_STAT(STAT_UNiq_CalculateCachedCollectionColor);
+DEFINE_STAT(STAT_UNiq_ImagePaint);
+
+DEFINE_STAT(STAT_UNiq_ParameterUpdates);
+DEFINE_STAT(STAT_UNiq_UpdateFanOut);
+DEFINE_STAT(STAT_UNiq_UnsubscribedUpdates);
+DEFINE_STAT(STAT_UNiq_SynchronousLoads);
+DEFINE_STAT(STAT_UNiq_PaintInvalidations);
+
+UE_TRACE_CHANNEL_DEFINE(UNiqChannel);
\ No newline at end of file
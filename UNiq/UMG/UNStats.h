@@ -0,0 +1,35 @@
+﻿// "Copyright (C) Craig Williams, SlashParadox"
+
+#pragma once
+
+#include "Stats/Stats.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include "Trace/Trace.h"
+
+DECLARE_STATS_GROUP(TEXT("UNiq"), STATGROUP_UNiq, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Rebind Color Data"), STAT_UNiq_RebindColorData, STATGROUP_UNiq, UNIQ_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Resolve Color Data Parameter"), STAT_UNiq_ResolveColorDataParameter, STATGROUP_UNiq, UNIQ_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("On Vector Parameter Updated"), STAT_UNiq_OnVectorParameterUpdated, STATGROUP_UNiq, UNIQ_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("On Scalar Parameter Updated"), STAT_UNiq_OnScalarParameterUpdated, STATGROUP_UNiq, UNIQ_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Calculate Cached Collection Color"), STAT_UNiq_CalculateCachedCollectionColor, STATGROUP_UNiq, UNIQ_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("SUNImage Paint"), STAT_UNiq_ImagePaint, STATGROUP_UNiq, UNIQ_API);
+
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Parameter Updates"), STAT_UNiq_ParameterUpdates, STATGROUP_UNiq, UNIQ_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Update Fan-Out"), STAT_UNiq_UpdateFanOut, STATGROUP_UNiq, UNIQ_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Unsubscribed Parameter Updates"), STAT_UNiq_UnsubscribedUpdates, STATGROUP_UNiq, UNIQ_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Synchronous Loads"), STAT_UNiq_SynchronousLoads, STATGROUP_UNiq, UNIQ_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Paint Invalidations"), STAT_UNiq_PaintInvalidations, STATGROUP_UNiq, UNIQ_API);
+
+UE_TRACE_CHANNEL_EXTERN(UNiqChannel, UNIQ_API);
+
+/**
+ * Scopes a UNiq hot path. With stats compiled in, it shows up under STATGROUP_UNiq in stat captures, and the cycle
+ * counter already traces a CPU event for Unreal Insights. Without stats, it traces a CPU event on the UNiqChannel
+ * instead. Enable that with -trace=cpu,UNiq. Only one of the two is ever emitted, so scopes are not doubled up.
+ */
+#if STATS
+#define UN_SCOPE_CYCLE_COUNTER(Stat) SCOPE_CYCLE_COUNTER(Stat)
+#else
+#define UN_SCOPE_CYCLE_COUNTER(Stat) TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL(Stat, UNiqChannel)
+#endif
\ No newline at end of file